@@ -41,6 +41,13 @@ void CompressArray(const unsigned char* in, size_t in_len,
                    unsigned char* out, size_t out_len,
                    size_t bit_len, size_t byte_pad=0);
 
+// Hash of index g: the sum of the Blake2b outputs over the 16-aligned index group up to g
+void GenerateHash(const eh_HashState& base_state, eh_index g,
+                  unsigned char* hash, size_t hLen, size_t N, size_t R);
+// The same for nG indices, hashes are hLen bytes each. The Blake2b compressions run in parallel lanes
+void GenerateHashes(const eh_HashState& base_state, const eh_index* pG, size_t nG,
+                    unsigned char* hashes, size_t hLen, size_t N, size_t R);
+
 eh_index ArrayToEhIndex(const unsigned char* array);
 eh_trunc TruncateIndex(const eh_index i, const unsigned int ilen);
 
@@ -47,6 +47,91 @@ namespace
             }
 	}	
     }
+
+    // Multi-lane Blake2b for the index hashes. All of them continue the same base state, and the
+    // index bytes always end up in the last block, so every hash is a single compression that
+    // differs from the others in the message only.
+#if defined(__GNUC__)
+#   define EH_HASH_LANES
+    const size_t HASH_LANES = 4;
+    typedef uint64_t LaneWord __attribute__((vector_size(HASH_LANES * sizeof(uint64_t))));
+
+    const uint64_t s_BlakeIV[8] =
+    {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+
+    const uint8_t s_BlakeSigma[12][16] =
+    {
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+        { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+        { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+        {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+        {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+        {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+        { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+        { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+        {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+        { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+        { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+    };
+
+#   define EH_ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#   define EH_LANE_G(a, b, c, d, x, y) \
+        a = a + b + x; d = EH_ROTR64(d ^ a, 32); c = c + d; b = EH_ROTR64(b ^ c, 24); \
+        a = a + b + y; d = EH_ROTR64(d ^ a, 16); c = c + d; b = EH_ROTR64(b ^ c, 63);
+
+    // Last-block compression of HASH_LANES messages with the same chaining value and byte counter.
+    // On x86-64 Linux an AVX2 clone is picked at runtime, otherwise the vectors are as wide as the target allows
+#if !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+    __attribute__((target_clones("avx2", "default")))
+#endif
+    void CompressLastBlockLanes(const uint64_t* h, uint64_t counter, const LaneWord* m, LaneWord* out)
+    {
+        const LaneWord z = {};
+        LaneWord v0 = z + h[0], v1 = z + h[1], v2 = z + h[2], v3 = z + h[3];
+        LaneWord v4 = z + h[4], v5 = z + h[5], v6 = z + h[6], v7 = z + h[7];
+        LaneWord v8 = z + s_BlakeIV[0], v9 = z + s_BlakeIV[1], v10 = z + s_BlakeIV[2], v11 = z + s_BlakeIV[3];
+        LaneWord v12 = z + (s_BlakeIV[4] ^ counter), v13 = z + s_BlakeIV[5];
+        LaneWord v14 = z + ~s_BlakeIV[6], v15 = z + s_BlakeIV[7]; // last block
+
+        for (size_t r = 0; r < 12; r++) {
+            const uint8_t* s = s_BlakeSigma[r];
+            EH_LANE_G(v0, v4,  v8, v12, m[s[ 0]], m[s[ 1]]);
+            EH_LANE_G(v1, v5,  v9, v13, m[s[ 2]], m[s[ 3]]);
+            EH_LANE_G(v2, v6, v10, v14, m[s[ 4]], m[s[ 5]]);
+            EH_LANE_G(v3, v7, v11, v15, m[s[ 6]], m[s[ 7]]);
+            EH_LANE_G(v0, v5, v10, v15, m[s[ 8]], m[s[ 9]]);
+            EH_LANE_G(v1, v6, v11, v12, m[s[10]], m[s[11]]);
+            EH_LANE_G(v2, v7,  v8, v13, m[s[12]], m[s[13]]);
+            EH_LANE_G(v3, v4,  v9, v14, m[s[14]], m[s[15]]);
+        }
+
+        out[0] = (z + h[0]) ^ v0 ^ v8;
+        out[1] = (z + h[1]) ^ v1 ^ v9;
+        out[2] = (z + h[2]) ^ v2 ^ v10;
+        out[3] = (z + h[3]) ^ v3 ^ v11;
+        out[4] = (z + h[4]) ^ v4 ^ v12;
+        out[5] = (z + h[5]) ^ v5 ^ v13;
+        out[6] = (z + h[6]) ^ v6 ^ v14;
+        out[7] = (z + h[7]) ^ v7 ^ v15;
+    }
+
+#   undef EH_LANE_G
+#   undef EH_ROTR64
+
+    // bytes hashed by the base state so far, not counting the buffered ones
+    inline uint64_t GetBlakeCounter(const eh_HashState& s)
+    {
+#if defined(__ANDROID__) || !defined(BEAM_USE_AVX)
+        return s.t[0];
+#else
+        return s.counter;
+#endif
+    }
+#endif // __GNUC__
 }
 
 template<unsigned int N, unsigned int K, unsigned int R>
@@ -100,6 +185,87 @@ void GenerateHash(const eh_HashState& base_state, eh_index g,
     ZeroizeUnusedBits(N, R, hash, hLen);
 }
 
+void GenerateHashes(const eh_HashState& base_state, const eh_index* pG, size_t nG,
+                    unsigned char* hashes, size_t hLen, size_t N, size_t R)
+{
+    assert(hLen <= BLAKE2B_OUTBYTES);
+
+    const size_t buflen = base_state.buflen;
+#ifdef EH_HASH_LANES
+    if (buflen + sizeof(eh_index) > BLAKE2B_BLOCKBYTES)
+#endif
+    {
+        // no lanes, or the index would start a new block and there is no shared last block
+        for (size_t k = 0; k < nG; k++) {
+            GenerateHash(base_state, pG[k], hashes + k * hLen, hLen, N, R);
+        }
+        return;
+    }
+
+#ifdef EH_HASH_LANES
+
+    const uint64_t counter = GetBlakeCounter(base_state) + buflen + sizeof(eh_index);
+
+    // every index sums the hashes of its group, the lanes are filled across the groups
+    std::vector<eh_index> vIdx;
+    std::vector<uint32_t> vOwner;
+    vIdx.reserve(nG * 16);
+    vOwner.reserve(nG * 16);
+    for (size_t k = 0; k < nG; k++) {
+        for (uint32_t g2 = pG[k] & 0xFFFFFFF0; g2 <= pG[k]; g2++) {
+            vIdx.push_back(g2);
+            vOwner.push_back((uint32_t) k);
+        }
+    }
+
+    std::vector<uint32_t> vSum(nG * 16, 0);
+
+    unsigned char block[BLAKE2B_BLOCKBYTES] = {0};
+    memcpy(block, base_state.buf, buflen);
+
+    LaneWord m[16];
+    LaneWord out[8];
+
+    for (size_t i = 0; i < vIdx.size(); i += HASH_LANES) {
+        size_t nLanes = std::min(HASH_LANES, vIdx.size() - i);
+
+        for (size_t l = 0; l < HASH_LANES; l++) {
+            eh_index lei = htole32(vIdx[i + std::min(l, nLanes - 1)]);
+            memcpy(block + buflen, &lei, sizeof(eh_index));
+            for (size_t w = 0; w < 16; w++) {
+                uint64_t x;
+                memcpy(&x, block + w * sizeof(uint64_t), sizeof(uint64_t));
+                m[w][l] = x;
+            }
+        }
+
+        CompressLastBlockLanes(base_state.h, counter, m, out);
+
+        for (size_t l = 0; l < nLanes; l++) {
+            unsigned char tmpHash[BLAKE2B_OUTBYTES] = {0};
+            for (size_t w = 0; w < 8; w++) {
+                uint64_t x = out[w][l];
+                memcpy(tmpHash + w * sizeof(uint64_t), &x, sizeof(uint64_t));
+            }
+            memset(tmpHash + hLen, 0, BLAKE2B_OUTBYTES - hLen); // as blake2b_final outputs hLen bytes
+
+            uint32_t* pSum = &vSum[vOwner[i + l] * 16];
+            for (size_t idx = 0; idx < 16; idx++) {
+                uint32_t x;
+                memcpy(&x, tmpHash + idx * sizeof(uint32_t), sizeof(uint32_t));
+                pSum[idx] += x;
+            }
+        }
+    }
+
+    for (size_t k = 0; k < nG; k++) {
+        unsigned char* hash = hashes + k * hLen;
+        memcpy(hash, &vSum[k * 16], hLen);
+        ZeroizeUnusedBits(N, R, hash, hLen);
+    }
+#endif // EH_HASH_LANES
+}
+
 void ExpandArray(const unsigned char* in, size_t in_len,
                  unsigned char* out, size_t out_len,
                  size_t bit_len, size_t byte_pad)
@@ -650,15 +816,25 @@ bool EquihashR<N,K,R>::IsValidSolution(const eh_HashState& base_state, std::vect
         return false;
     }
 
-    std::vector<FullStepRow<FinalFullWidth>> X;
-    X.reserve(1 << K);
-    unsigned char tmpHash[HashOutput];
-    for (eh_index i : GetIndicesFromMinimal(soln, CollisionBitLength)) {
+    std::vector<eh_index> indices = GetIndicesFromMinimal(soln, CollisionBitLength);
+    std::vector<eh_index> vG;
+    vG.reserve(indices.size());
+    for (eh_index i : indices) {
 	if (i >= (1U << (CollisionBitLength + 1 - R))) {
             return false;
 	}
-        GenerateHash(base_state, i/IndicesPerHashOutput, tmpHash, HashOutput, N, R);
-        X.emplace_back(tmpHash+((i % IndicesPerHashOutput) * GetSizeInBytes(N)),
+        vG.push_back(i/IndicesPerHashOutput);
+    }
+
+    // all the hashes at once, in Blake2b lanes
+    std::vector<unsigned char> hashes(indices.size() * HashOutput);
+    GenerateHashes(base_state, vG.data(), vG.size(), hashes.data(), HashOutput, N, R);
+
+    std::vector<FullStepRow<FinalFullWidth>> X;
+    X.reserve(1 << K);
+    for (size_t k = 0; k < indices.size(); k++) {
+        eh_index i = indices[k];
+        X.emplace_back(&hashes[k * HashOutput] + ((i % IndicesPerHashOutput) * GetSizeInBytes(N)),
                        GetSizeInBytes(N), HashLength, CollisionBitLength, i);
     }
 
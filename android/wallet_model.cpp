@@ -175,7 +175,7 @@ void WalletModel::onChangeCalculated(Amount change)
     env->CallStaticVoidMethod(WalletListenerClass, callback, change);
 }
 
-void WalletModel::onAllUtxoChanged(const std::vector<Coin>& utxosVec)
+void WalletModel::onAllUtxoChanged(const std::vector<Coin>& utxosVec, uint64_t)
 {
     LOG_DEBUG() << "onAllUtxoChanged()";
 
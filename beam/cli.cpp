@@ -178,7 +178,8 @@ int main_impl(int argc, char* argv[])
 #define LOG_FILES_PREFIX "node_"
 
 		const auto path = boost::filesystem::system_complete(LOG_FILES_DIR);
-		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string());
+		size_t logAsyncBuffer = size_t(vm[cli::LOG_ASYNC_BUFFER].as<uint32_t>()) * 1024;
+		auto logger = beam::Logger::create(logLevel, logLevel, fileLogLevel, LOG_FILES_PREFIX, path.string(), logAsyncBuffer);
 
 		try
 		{
@@ -214,6 +215,7 @@ int main_impl(int argc, char* argv[])
 				if (stratumPort > 0) {
 					IExternalPOW::Options powOptions;
                     find_certificates(powOptions, vm[cli::STRATUM_SECRETS_PATH].as<string>(), vm[cli::STRATUM_USE_TLS].as<bool>());
+                    powOptions.shareInterval = vm[cli::STRATUM_SHARE_INTERVAL].as<unsigned>();
                     unsigned noncePrefixDigits = vm[cli::NONCEPREFIX_DIGITS].as<unsigned>();
                     if (noncePrefixDigits > 6) noncePrefixDigits = 6;
 					stratumServer = IExternalPOW::create(powOptions, *reactor, io::Address().port(stratumPort), noncePrefixDigits);
@@ -783,7 +783,7 @@ namespace beam
 		void Create(ISource&, const SystemState::Full& sRoot);
 		bool IsValid(SystemState::Full* pTip = NULL) const;
 		bool Crop(); // according to current bound
-		bool Crop(const ChainWorkProof& src);
+		bool Crop(const ChainWorkProof& src, bool bSrcTrusted = false); // trusted src (created locally) skips PoW verification
 		bool IsEmpty() const { return m_Heading.m_vElements.empty(); }
 
 		template <typename Archive>
@@ -809,7 +809,7 @@ namespace beam
 
 	private:
 		struct Sampler;
-		bool IsValidInternal(size_t& iState, size_t& iHash, const Difficulty::Raw& lowerBound, SystemState::Full* pTip) const;
+		bool IsValidInternal(size_t& iState, size_t& iHash, const Difficulty::Raw& lowerBound, SystemState::Full* pTip, bool bTestPoW = true) const;
 		void ZeroInit();
 		bool EnumStatesHeadingOnly(IStateWalker&) const; // skip arbitrary
 	};
@@ -644,62 +644,79 @@ namespace beam
 
 	/////////////
 	// RecoveryInfo
-	void RecoveryInfo::Reader::ThrowRulesMismatch()
-	{
-		throw std::runtime_error("Rules mismatch");
-	}
+	const uint8_t RecoveryInfo::s_pSignature[8] = { 'B', 'e', 'a', 'm', 'R', 'c', 'S', '1' };
 
-	void RecoveryInfo::Writer::Open(const char* sz, const Block::ChainWorkProof& cwp)
+	namespace
 	{
-		m_Stream.Open(sz, false, true);
-		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(m_Stream);
+		template <typename Archive>
+		void RecoveryWriteHeader(Archive& ser, const Block::ChainWorkProof& cwp)
+		{
+			Height hMax = cwp.m_Heading.m_Prefix.m_Height + cwp.m_Heading.m_vElements.size() - 1;
 
-		Height hMax = cwp.m_Heading.m_Prefix.m_Height + cwp.m_Heading.m_vElements.size() - 1;
+			const Rules& r = Rules::get();
+
+			uint32_t nForks = 0;
+			for (; nForks < _countof(r.pForks); nForks++)
+			{
+				if (hMax < r.pForks[nForks].m_Height)
+					break;
+			}
 
-		const Rules& r = Rules::get();
+			ser & nForks;
+			for (uint32_t iFork = 0; iFork < nForks; iFork++)
+				ser & r.pForks[iFork].m_Hash;
 
-		uint32_t nForks = 0;
-		for (; nForks < _countof(r.pForks); nForks++)
-		{
-			if (hMax < r.pForks[nForks].m_Height)
-				break;
+			ser & cwp;
 		}
 
-		ser & nForks;
-		for (uint32_t iFork = 0; iFork < nForks; iFork++)
-			ser & r.pForks[iFork].m_Hash;
+		template <typename Archive>
+		void RecoveryReadHeader(Archive& der, Block::ChainWorkProof& cwp, Block::SystemState::Full& sTip)
+		{
+			uint32_t nForks = 0;
+			der & nForks;
 
-		ser & cwp;
-	}
+			const Rules& r = Rules::get();
+			if (nForks > _countof(r.pForks))
+				RecoveryInfo::Reader::ThrowRulesMismatch();
 
-	void RecoveryInfo::Reader::Open(const char* sz)
-	{
-		m_Stream.Open(sz, true, true);
-		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(m_Stream);
+			for (uint32_t iFork = 0; iFork < nForks; iFork++)
+			{
+				ECC::Hash::Value hv;
+				der & hv;
 
-		uint32_t nForks = 0;
-		der & nForks;
+				if (hv != r.pForks[iFork].m_Hash)
+					RecoveryInfo::Reader::ThrowRulesMismatch();
+			}
 
-		const Rules& r = Rules::get();
-		if (nForks > _countof(r.pForks))
-			ThrowRulesMismatch();
+			der & cwp;
 
-		for (uint32_t iFork = 0; iFork < nForks; iFork++)
-		{
-			ECC::Hash::Value hv;
-			der & hv;
+			if (!cwp.IsValid(&sTip))
+				throw std::runtime_error("CWP error");
 
-			if (hv != r.pForks[iFork].m_Hash)
-				ThrowRulesMismatch();
+			if ((nForks < _countof(r.pForks)) && (sTip.m_Height >= r.pForks[nForks].m_Height))
+				RecoveryInfo::Reader::ThrowRulesMismatch();
 		}
+	}
 
-		der & m_Cwp;
+	void RecoveryInfo::Reader::ThrowRulesMismatch()
+	{
+		throw std::runtime_error("Rules mismatch");
+	}
 
-		if (!m_Cwp.IsValid(&m_Tip))
-			throw std::runtime_error("CWP error");
+	void RecoveryInfo::Writer::Open(const char* sz, const Block::ChainWorkProof& cwp)
+	{
+		m_Stream.Open(sz, false, true);
+		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(m_Stream);
 
-		if ((nForks < _countof(r.pForks)) && (m_Tip.m_Height >= r.pForks[nForks].m_Height))
-			ThrowRulesMismatch();
+		RecoveryWriteHeader(ser, cwp);
+	}
+
+	void RecoveryInfo::Reader::Open(const char* sz)
+	{
+		m_Stream.Open(sz, true, true);
+		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(m_Stream);
+
+		RecoveryReadHeader(der, m_Cwp, m_Tip);
 	}
 
 	void RecoveryInfo::Writer::Write(const Entry& x)
@@ -708,6 +725,15 @@ namespace beam
 		ser & x;
 	}
 
+	void RecoveryInfo::get_Key(UtxoTree::Key& key, const Entry& x)
+	{
+		UtxoTree::Key::Data d;
+		d.m_Commitment = x.m_Output.m_Commitment;
+		d.m_Maturity = x.m_Output.get_MinMaturity(x.m_CreateHeight);
+
+		key = d;
+	}
+
 	bool RecoveryInfo::Reader::Read(Entry& x)
 	{
 		if (!m_Stream.get_Remaining())
@@ -716,12 +742,8 @@ namespace beam
 		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(m_Stream);
 		der & x;
 
-		UtxoTree::Key::Data d;
-		d.m_Commitment = x.m_Output.m_Commitment;
-		d.m_Maturity = x.m_Output.get_MinMaturity(x.m_CreateHeight);
-
 		UtxoTree::Key key;
-		key = d;
+		get_Key(key, x);
 
 		if (!m_UtxoTree.Add(key))
 			throw std::runtime_error("UTXO order mismatch");
@@ -738,4 +760,239 @@ namespace beam
 			throw std::runtime_error("UTXO hash mismatch");
 	}
 
+	void RecoveryInfo::VerifyUtxos(std::vector<UtxoTree::Key>& vKeys, const Merkle::Hash& hvRootLive)
+	{
+		std::sort(vKeys.begin(), vKeys.end(), [](const UtxoTree::Key& a, const UtxoTree::Key& b) { return a.V.cmp(b.V) < 0; });
+
+		UtxoTree::Compact ut;
+		for (size_t i = 0; i < vKeys.size(); i++)
+			if (!ut.Add(vKeys[i]))
+				throw std::runtime_error("UTXO order mismatch");
+
+		Merkle::Hash hv;
+		ut.Flush(hv);
+
+		if (!(hvRootLive == hv))
+			throw std::runtime_error("UTXO hash mismatch");
+	}
+
+	const RecoveryInfo::Segment* RecoveryInfo::Index::Find(Height hMin) const
+	{
+		auto it = std::lower_bound(m_vSegments.begin(), m_vSegments.end(), hMin, [](const Segment& s, Height h) { return s.m_Heights.m_Min < h; });
+		return ((m_vSegments.end() != it) && (it->m_Heights.m_Min == hMin)) ? &(*it) : nullptr;
+	}
+
+	uint64_t RecoveryInfo::Index::get_SizeLive() const
+	{
+		uint64_t nRet = 0;
+		for (size_t i = 0; i < m_vSegments.size(); i++)
+			nRet += m_vSegments[i].m_Size;
+		return nRet;
+	}
+
+	bool RecoveryInfo::SegmentedReader::IsSegmented(const char* sz)
+	{
+		std::FStream fs;
+		if (!fs.Open(sz, true) || (fs.get_Remaining() < sizeof(s_pSignature)))
+			return false;
+
+		uint8_t pSig[sizeof(s_pSignature)];
+		fs.read(pSig, sizeof(pSig));
+		return !memcmp(pSig, s_pSignature, sizeof(pSig));
+	}
+
+	void RecoveryInfo::SegmentedReader::Open(const char* sz)
+	{
+		std::FStream fs;
+		fs.Open(sz, true, true);
+		Open(fs);
+	}
+
+	uint64_t RecoveryInfo::SegmentedReader::Open(std::FStream& fs)
+	{
+		uint64_t nSize = fs.get_Remaining();
+		uintBigFor<uint64_t>::Type offs;
+
+		if (nSize < sizeof(s_pSignature) + offs.nBytes)
+			throw std::runtime_error("Recovery file too short");
+
+		uint8_t pSig[sizeof(s_pSignature)];
+		fs.read(pSig, sizeof(pSig));
+		if (memcmp(pSig, s_pSignature, sizeof(pSig)))
+			throw std::runtime_error("Recovery file signature mismatch");
+
+		fs.Seek(nSize - offs.nBytes);
+		fs.read(offs.m_pData, offs.nBytes);
+
+		uint64_t nIndex;
+		offs.Export(nIndex);
+		if ((nIndex < sizeof(s_pSignature)) || (nIndex > nSize - offs.nBytes))
+			throw std::runtime_error("Recovery index offset mismatch");
+
+		fs.Seek(nIndex);
+
+		yas::binary_iarchive<std::FStream, SERIALIZE_OPTIONS> der(fs);
+		RecoveryReadHeader(der, m_Index.m_Cwp, m_Tip);
+
+		der
+			& m_Index.m_vSegments
+			& m_Index.m_SizeDead;
+
+		for (size_t i = 0; i < m_Index.m_vSegments.size(); i++)
+		{
+			const Segment& seg = m_Index.m_vSegments[i];
+			if ((seg.m_Offset < sizeof(s_pSignature)) || (seg.m_Offset > nIndex) || (seg.m_Size > nIndex - seg.m_Offset))
+				throw std::runtime_error("Recovery segment out of bounds");
+
+			if (i && (m_Index.m_vSegments[i - 1].m_Heights.m_Max >= seg.m_Heights.m_Min))
+				throw std::runtime_error("Recovery segments order mismatch");
+		}
+
+		return nSize;
+	}
+
+	void RecoveryInfo::SegmentedWriter::Create(const char* sz)
+	{
+		m_Stream.Close(); // in case the append was abandoned
+		m_Stream.Open(sz, false, true);
+		m_Stream.write(s_pSignature, sizeof(s_pSignature));
+		m_Pos = sizeof(s_pSignature);
+
+		m_Index.m_vSegments.clear();
+		m_Index.m_SizeDead = 0;
+	}
+
+	bool RecoveryInfo::SegmentedWriter::Append(const char* szPrev, const char* szPath)
+	{
+		try
+		{
+			std::FStream fsPrev;
+			if (!fsPrev.Open(szPrev, true))
+				return false;
+
+			SegmentedReader rp;
+			uint64_t nSize = rp.Open(fsPrev);
+
+			m_Index = std::move(rp.m_Index);
+			m_Tip = rp.m_Tip;
+
+			// copy the whole file, the old index becomes dead
+			fsPrev.Restart();
+			m_Stream.Open(szPath, false, true);
+
+			std::vector<uint8_t> vBuf(0x100000);
+			for (uint64_t nDone = 0; nDone < nSize; )
+			{
+				size_t n = static_cast<size_t>(std::min<uint64_t>(vBuf.size(), nSize - nDone));
+				fsPrev.read(&vBuf.front(), n);
+				m_Stream.write(&vBuf.front(), n);
+				nDone += n;
+			}
+
+			m_Index.m_SizeDead += nSize - sizeof(s_pSignature) - m_Index.get_SizeLive();
+			m_Pos = nSize;
+		}
+		catch (const std::exception&)
+		{
+			m_Stream.Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void RecoveryInfo::SegmentedWriter::SegmentStart(const HeightRange& hr)
+	{
+		m_Segment.m_Heights = hr;
+		m_Segment.m_Offset = m_Pos;
+		m_Segment.m_Size = 0;
+		m_Segment.m_Count = 0;
+		m_Hp.Reset();
+	}
+
+	void RecoveryInfo::SegmentedWriter::Write(const Entry& x)
+	{
+		m_Ser.reset();
+		m_Ser & x;
+
+		SerializeBuffer sb = m_Ser.buffer();
+		m_Stream.write(sb.first, sb.second);
+		m_Hp << Blob(sb.first, static_cast<uint32_t>(sb.second));
+
+		m_Segment.m_Size += sb.second;
+		m_Segment.m_Count++;
+		m_Pos += sb.second;
+	}
+
+	void RecoveryInfo::SegmentedWriter::SegmentEnd()
+	{
+		m_Hp >> m_Segment.m_Hash;
+
+		auto it = std::lower_bound(m_Index.m_vSegments.begin(), m_Index.m_vSegments.end(), m_Segment.m_Heights.m_Min,
+			[](const Segment& s, Height h) { return s.m_Heights.m_Min < h; });
+
+		// the segment ranges are aligned, the new one replaces the segment that starts at the same height
+		if ((m_Index.m_vSegments.end() != it) && (it->m_Heights.m_Min == m_Segment.m_Heights.m_Min))
+		{
+			m_Index.m_SizeDead += it->m_Size;
+			*it = m_Segment;
+		}
+		else
+			m_Index.m_vSegments.insert(it, m_Segment);
+	}
+
+	void RecoveryInfo::SegmentedWriter::Close(const Block::ChainWorkProof& cwp)
+	{
+		m_Index.m_Cwp = cwp;
+
+		Serializer ser;
+		RecoveryWriteHeader(ser, cwp);
+
+		ser
+			& m_Index.m_vSegments
+			& m_Index.m_SizeDead;
+
+		SerializeBuffer sb = ser.buffer();
+		m_Stream.write(sb.first, sb.second);
+
+		uintBigFor<uint64_t>::Type offs = m_Pos;
+		m_Stream.write(offs.m_pData, offs.nBytes);
+
+		m_Pos += sb.second + offs.nBytes;
+
+		m_Stream.Flush();
+		m_Stream.Close();
+	}
+
+	void RecoveryInfo::SegmentParser::Open(const Segment& seg, const Blob& file)
+	{
+		if ((seg.m_Offset > file.n) || (seg.m_Size > file.n - seg.m_Offset))
+			throw std::runtime_error("Recovery segment out of bounds");
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(file.p) + seg.m_Offset;
+		uint32_t n = static_cast<uint32_t>(seg.m_Size);
+
+		Merkle::Hash hv;
+		ECC::Hash::Processor() << Blob(p, n) >> hv;
+		if (hv != seg.m_Hash)
+			throw std::runtime_error("Recovery segment hash mismatch");
+
+		m_Der.reset(p, n);
+		m_Remaining = seg.m_Count;
+	}
+
+	bool RecoveryInfo::SegmentParser::Read(Entry& x)
+	{
+		if (!m_Remaining)
+		{
+			if (m_Der.bytes_left())
+				throw std::runtime_error("Recovery segment size mismatch");
+			return false;
+		}
+
+		m_Remaining--;
+		m_Der & x;
+		return true;
+	}
+
 } // namespace beam
@@ -15,6 +15,7 @@
 #pragma once
 #include "block_crypt.h"
 #include "radixtree.h"
+#include "utility/serialize.h"
 
 namespace beam
 {
@@ -170,6 +171,89 @@ namespace beam
 
 			static void ThrowRulesMismatch();
 		};
+
+		static void get_Key(UtxoTree::Key&, const Entry&);
+		static void VerifyUtxos(std::vector<UtxoTree::Key>&, const Merkle::Hash& hvRootLive); // sorts the keys
+
+		// Segmented format.
+		// The UTXOs are grouped by their creation height, one segment per s_SegmentHeights range, and are followed by the index.
+		// The file is append-only: new segments (and replacements for the segments whose UTXOs were spent) are appended
+		// together with the new index, the replaced data and the old index become dead. The last 8 bytes are the index offset.
+		static const Height s_SegmentHeights = 1440;
+		static const uint8_t s_pSignature[8];
+
+		struct Segment
+		{
+			HeightRange m_Heights;
+			uint64_t m_Offset;
+			uint64_t m_Size;
+			uint32_t m_Count;
+			Merkle::Hash m_Hash;
+
+			template <typename Archive>
+			void serialize(Archive& ar)
+			{
+				ar
+					& m_Heights.m_Min
+					& m_Heights.m_Max
+					& m_Offset
+					& m_Size
+					& m_Count
+					& m_Hash;
+			}
+		};
+
+		struct Index
+		{
+			Block::ChainWorkProof m_Cwp;
+			std::vector<Segment> m_vSegments; // sorted by height
+			uint64_t m_SizeDead = 0;
+
+			const Segment* Find(Height hMin) const;
+			uint64_t get_SizeLive() const;
+		};
+
+		struct SegmentedReader
+		{
+			Index m_Index;
+			Block::SystemState::Full m_Tip;
+
+			static bool IsSegmented(const char*);
+			void Open(const char*); // reads and verifies the index
+			uint64_t Open(std::FStream&); // returns the file size
+		};
+
+		struct SegmentedWriter
+		{
+			std::FStream m_Stream;
+			Index m_Index;
+			Block::SystemState::Full m_Tip; // of the appended file
+
+			void Create(const char*);
+			bool Append(const char* szPrev, const char* szPath); // copies the previous file, false if it's not a valid segmented file
+
+			void SegmentStart(const HeightRange&);
+			void Write(const Entry&);
+			void SegmentEnd();
+
+			void Close(const Block::ChainWorkProof&); // writes the index
+
+		private:
+			uint64_t m_Pos = 0;
+			Segment m_Segment;
+			ECC::Hash::Processor m_Hp;
+			Serializer m_Ser;
+		};
+
+		// Parses a segment of the file mapped into memory, can be used concurrently for different segments
+		struct SegmentParser
+		{
+			Deserializer m_Der;
+			uint32_t m_Remaining;
+
+			void Open(const Segment&, const Blob& file); // verifies the bounds and the hash
+			bool Read(Entry&);
+		};
 	};
 
 }
@@ -268,10 +268,10 @@ namespace beam
 		std::copy(src.cbegin(), src.cbegin() + dst.size(), dst.begin());
 	}
 
-	bool Block::ChainWorkProof::Crop(const ChainWorkProof& src)
+	bool Block::ChainWorkProof::Crop(const ChainWorkProof& src, bool bSrcTrusted)
 	{
 		size_t iState, iHash;
-		if (!src.IsValidInternal(iState, iHash, m_LowerBound, NULL))
+		if (!src.IsValidInternal(iState, iHash, m_LowerBound, NULL, !bSrcTrusted))
 			return false;
 
 		bool bInPlace = (&src == this);
@@ -333,7 +333,7 @@ namespace beam
 		return Crop(*this);
 	}
 
-	bool Block::ChainWorkProof::IsValidInternal(size_t& iState, size_t& iHash, const Difficulty::Raw& lowerBound, Block::SystemState::Full* pTip) const
+	bool Block::ChainWorkProof::IsValidInternal(size_t& iState, size_t& iHash, const Difficulty::Raw& lowerBound, Block::SystemState::Full* pTip, bool bTestPoW) const
 	{
 		if (m_Heading.m_vElements.empty())
 			return false;
@@ -342,10 +342,11 @@ namespace beam
 			:public IStateWalker
 		{
 			Block::SystemState::Full m_Tip;
+			bool m_bTestPoW;
 
 			virtual bool OnState(const SystemState::Full& s, bool bIsTip) override
 			{
-				if (!(s.IsValid()))
+				if (!(m_bTestPoW ? s.IsValid() : s.IsSane()))
 					return false;
 
 				if (bIsTip)
@@ -356,6 +357,7 @@ namespace beam
 
 		} wlk;
 
+		wlk.m_bTestPoW = bTestPoW;
 		if (!EnumStates(wlk))
 			return false;
 
@@ -211,6 +211,9 @@ void FlyClient::NetworkStd::Connection::OnMsg(Authentication&& msg)
             //  viewer confirmed!
             m_Flags |= Flags::Owned;
             m_This.m_Client.OnOwnedNode(m_NodeID, true);
+
+            if (m_This.m_pUtxoEventsReceiver)
+                SendUtxoEventsSubscribe(true);
         }
         break;
 
@@ -256,6 +259,21 @@ void FlyClient::NetworkStd::Connection::OnLogin(Login&& msg)
             msgOut.m_On = true;
             Send(msgOut);
         }
+
+    if (m_This.m_pUtxoEventsReceiver)
+        SendUtxoEventsSubscribe(true);
+}
+
+void FlyClient::NetworkStd::Connection::SendUtxoEventsSubscribe(bool bOn)
+{
+    // only the owned nodes that advertise the support
+    if ((Flags::Owned & m_Flags) && (LoginFlags::UtxoEventsPush & m_LoginFlags))
+    {
+        proto::UtxoEventsSubscribe msg;
+        msg.m_HeightMin = m_This.m_hUtxoEventsNext;
+        msg.m_On = bOn;
+        Send(msg);
+    }
 }
 
 void FlyClient::NetworkStd::Connection::OnMsg(NewTip&& msg)
@@ -865,5 +883,32 @@ void FlyClient::NetworkStd::Connection::OnMsg(BbsMsg&& msg)
     }
 }
 
+void FlyClient::NetworkStd::UtxoEventsSubscribe(Height h, IUtxoEventsReceiver* p)
+{
+    if ((m_pUtxoEventsReceiver == p) && (!p || (m_hUtxoEventsNext == h)))
+        return;
+
+    m_pUtxoEventsReceiver = p;
+    m_hUtxoEventsNext = h;
+
+    for (ConnectionList::iterator it = m_Connections.begin(); m_Connections.end() != it; it++)
+        if (it->IsLive() && it->IsSecureOut())
+            it->SendUtxoEventsSubscribe(NULL != p);
+}
+
+void FlyClient::NetworkStd::Connection::OnMsg(UtxoEventsNew&& msg)
+{
+    if (!(Flags::Owned & m_Flags))
+        ThrowUnexpected();
+
+    if (!m_This.m_pUtxoEventsReceiver)
+        return; // unsubscribed already
+
+    if (m_This.m_hUtxoEventsNext < msg.m_HeightNext)
+        m_This.m_hUtxoEventsNext = msg.m_HeightNext;
+
+    m_This.m_pUtxoEventsReceiver->OnMsg(std::move(msg));
+}
+
 } // namespace proto
 } // namespace beam
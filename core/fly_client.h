@@ -88,6 +88,11 @@ namespace proto {
 			virtual void OnMsg(proto::BbsMsg&&) = 0;
 		};
 
+		struct IUtxoEventsReceiver
+		{
+			virtual void OnMsg(proto::UtxoEventsNew&&) = 0;
+		};
+
 		struct INetwork
 		{
 			virtual ~INetwork() {}
@@ -96,6 +101,7 @@ namespace proto {
 			virtual void Disconnect() = 0;
 			virtual void PostRequestInternal(Request&) = 0;
 			virtual void BbsSubscribe(BbsChannel, Timestamp, IBbsReceiver*) {} // duplicates should be handled internally
+			virtual void UtxoEventsSubscribe(Height, IUtxoEventsReceiver*) {} // owned nodes would push the events from the specified height on
 
 			void PostRequest(Request&, Request::IHandler&);
 		};
@@ -210,6 +216,7 @@ namespace proto {
 				virtual void OnMsg(proto::ProofChainWork&& msg) override;
 				virtual void OnMsg(proto::BbsMsg&& msg) override;
 				virtual void OnMsg(proto::BbsMsgV0&& msg) override;
+				virtual void OnMsg(proto::UtxoEventsNew&& msg) override;
 #define THE_MACRO(type, msgOut, msgIn) \
 				virtual void OnMsg(proto::msgIn&&) override; \
 				bool IsSupported(Request##type&); \
@@ -219,6 +226,7 @@ namespace proto {
 
 				template <typename Req> void SendRequest(Req& r) { Send(r.m_Msg); }
 				void SendRequest(RequestBbsMsg&);
+				void SendUtxoEventsSubscribe(bool bOn);
 			};
 
 			typedef boost::intrusive::list<Connection> ConnectionList;
@@ -227,11 +235,15 @@ namespace proto {
 			typedef std::map<BbsChannel, std::pair<IBbsReceiver*, Timestamp> > BbsSubscriptions;
 			BbsSubscriptions m_BbsSubscriptions;
 
+			IUtxoEventsReceiver* m_pUtxoEventsReceiver = nullptr;
+			Height m_hUtxoEventsNext = 0;
+
 			// INetwork
 			virtual void Connect() override;
 			virtual void Disconnect() override;
 			virtual void PostRequestInternal(Request&) override;
 			virtual void BbsSubscribe(BbsChannel, Timestamp, IBbsReceiver*) override;
+			virtual void UtxoEventsSubscribe(Height, IUtxoEventsReceiver*) override;
 
 			// more events
 			virtual void OnNodeConnected(size_t iNodeIdx, bool) {}
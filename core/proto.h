@@ -205,6 +205,15 @@ namespace proto {
 #define BeamNodeMsg_UtxoEvents(macro) \
     macro(std::vector<UtxoEvent>, Events)
 
+#define BeamNodeMsg_UtxoEventsSubscribe(macro) \
+    macro(Height, HeightMin) \
+    macro(bool, On)
+
+#define BeamNodeMsg_UtxoEventsNew(macro) \
+    macro(Height, HeightMin) \
+    macro(Height, HeightNext) \
+    macro(std::vector<UtxoEvent>, Events)
+
 #define BeamNodeMsg_GetBlockFinalization(macro) \
     macro(Height, Height) \
     macro(Amount, Fees)
@@ -255,6 +264,8 @@ namespace proto {
     macro(0x26, GetBodyPack) \
     macro(0x27, BodyPack) \
     /* onwer-relevant */ \
+    macro(0x2a, UtxoEventsSubscribe) \
+    macro(0x2b, UtxoEventsNew) \
     macro(0x2c, GetUtxoEvents) \
     macro(0x2d, UtxoEvents) \
     macro(0x2e, GetBlockFinalization) \
@@ -282,7 +293,8 @@ namespace proto {
         static const uint8_t Extension1             = 0x10; // Supports Bbs with POW, more advanced proof/disproof scheme for SPV clients (?)
         static const uint8_t Extension2             = 0x20; // Supports large HdrPack, BlockPack with parameters
         static const uint8_t Extension3             = 0x40; // Supports Login1, Status (former Boolean) for NewTransaction result, compatible with Fork H1
-	    static const uint8_t Recognized             = 0x7f;
+        static const uint8_t UtxoEventsPush         = 0x80; // Supports UtxoEventsSubscribe, pushes UtxoEventsNew to the subscribed viewers
+	    static const uint8_t Recognized             = 0xff;
 
 		static const uint8_t ExtensionsAll =
 			Extension1 |
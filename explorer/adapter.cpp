@@ -20,6 +20,8 @@
 #include "nlohmann/json.hpp"
 #include "utility/helpers.h"
 #include "utility/logger.h"
+#include "utility/io/asyncevent.h"
+#include <atomic>
 
 namespace beam { namespace explorer {
 
@@ -27,6 +29,7 @@ namespace {
 
 static const size_t PACKER_FRAGMENTS_SIZE = 4096;
 static const size_t CACHE_DEPTH = 100000;
+static const size_t CACHE_MAX_BYTES = 256 * 1024 * 1024;
 
 const char* hash_to_hex(char* buf, const Merkle::Hash& hash) {
     return to_hex(buf, hash.m_pData, 32);
@@ -53,44 +56,163 @@ struct ResponseCache {
     Height currentHeight=0;
     Height lowHorizon=0;
 
-    explicit ResponseCache(size_t depth) : _depth(depth)
+    ResponseCache(size_t depth, size_t maxBytes) : _depth(depth), _maxBytes(maxBytes), _bytes(0)
     {}
 
     void compact() {
         if (blocks.empty() || currentHeight <= _depth) return;
         Height horizon = currentHeight - _depth;
-        if (blocks.rbegin()->first < horizon) {
-            blocks.clear();
-            return;
-        }
-        auto b = blocks.begin();
-        auto it = b;
-        while (it != blocks.end()) {
-            if (it->first >= horizon) break;
-            ++it;
-        }
-        blocks.erase(b, it);
+        erase(blocks.begin(), blocks.lower_bound(horizon));
     }
 
-    bool get_block(io::SerializedMsg& out, Height h) {
+    bool get_block(io::SharedBuffer& out, Height h) {
         const auto& it = blocks.find(h);
         if (it == blocks.end()) return false;
-        out.push_back(it->second);
+        out = it->second;
         return true;
     }
 
     void put_block(Height h, const io::SharedBuffer& body) {
         if (currentHeight - h > _depth) return;
         compact();
-        blocks[h] = body;
+        io::SharedBuffer& x = blocks[h];
+        _bytes -= x.size;
+        _bytes += body.size;
+        x = body;
+
+        // size bound, the oldest blocks are the least requested
+        while (_bytes > _maxBytes && blocks.size() > 1) {
+            erase(blocks.begin(), std::next(blocks.begin()));
+        }
+    }
+
+    void erase_from(Height h) {
+        erase(blocks.lower_bound(h), blocks.end());
     }
 
 private:
+    void erase(std::map<Height, io::SharedBuffer>::iterator b, std::map<Height, io::SharedBuffer>::iterator e) {
+        for (auto it = b; it != e; ++it) {
+            _bytes -= it->second.size;
+        }
+        blocks.erase(b, e);
+    }
+
     size_t _depth;
+    size_t _maxBytes;
+    size_t _bytes;
+};
+
+/// Block data read from the node db, rendered to json off the reactor thread
+struct BlockData {
+    Block::SystemState::Full state;
+    Block::SystemState::ID id;
+    Block::Body body;
+    io::SharedBuffer rendered;
 };
 
 using nlohmann::json;
 
+bool render_block(io::SharedBuffer& out, HttpMsgCreator& packer, const BlockData& b) {
+    char buf[80];
+
+    json inputs = json::array();
+    for (const auto &v : b.body.m_vInputs) {
+        inputs.push_back(
+        json{
+            {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
+            {"maturity",   v->m_Maturity}
+        }
+        );
+    }
+
+    json outputs = json::array();
+    for (const auto &v : b.body.m_vOutputs) {
+        outputs.push_back(
+        json{
+            {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
+            {"maturity",   v->m_Maturity},
+            {"coinbase",   v->m_Coinbase},
+            {"incubation", v->m_Incubation}
+        }
+        );
+    }
+
+    json kernels = json::array();
+    for (const auto &v : b.body.m_vKernels) {
+        Merkle::Hash kernelID;
+        v->get_ID(kernelID);
+        kernels.push_back(
+            json{
+                {"id", hash_to_hex(buf, kernelID)},
+                {"excess", uint256_to_hex(buf, v->m_Commitment.m_X)},
+                {"minHeight", v->m_Height.m_Min},
+                {"maxHeight", v->m_Height.m_Max},
+                {"fee", v->m_Fee}
+            }
+        );
+    }
+
+    json j{
+        {"found",      true},
+        {"timestamp",  b.state.m_TimeStamp},
+        {"height",     b.state.m_Height},
+        {"hash",       hash_to_hex(buf, b.id.m_Hash)},
+        {"prev",       hash_to_hex(buf, b.state.m_Prev)},
+        {"difficulty", b.state.m_PoW.m_Difficulty.ToFloat()},
+        {"chainwork",  uint256_to_hex(buf, b.state.m_ChainWork)},
+        {"subsidy",    Rules::get_Emission(b.state.m_Height)},
+        {"inputs",     inputs},
+        {"outputs",    outputs},
+        {"kernels",    kernels}
+    };
+
+    LOG_DEBUG() << j;
+
+    io::SerializedMsg sm;
+    if (!serialize_json_msg(sm, packer, j)) return false;
+    out = io::normalize(sm, false);
+    return true;
+}
+
+/// Range of blocks in flight: extracted on the reactor thread, rendered on the task processor threads
+struct BlocksRequest {
+    std::vector<BlockData> blocks; // descending order, the ones not rendered are either cached or missing
+    std::vector<BlockData*> toRender;
+    std::atomic<size_t> next;
+    std::atomic<uint32_t> tasksLeft;
+    Height endHeight=0;
+    uint64_t generation=0;
+    IAdapter::Callback callback;
+    io::AsyncEvent::Ptr done;
+
+    BlocksRequest() : next(0), tasksLeft(0)
+    {}
+};
+
+/// Renders blocks of the request, each task with its own packer. The last one to finish wakes the reactor
+struct BlockRenderTask : public NodeProcessor::Task {
+    std::shared_ptr<BlocksRequest> req;
+
+    explicit BlockRenderTask(const std::shared_ptr<BlocksRequest>& r) : req(r)
+    {}
+
+    void Exec() override {
+        HttpMsgCreator packer(PACKER_FRAGMENTS_SIZE);
+        while (true) {
+            size_t i = req->next++;
+            if (i >= req->toRender.size()) break;
+            BlockData& b = *req->toRender[i];
+            if (!render_block(b.rendered, packer, b)) {
+                b.rendered = io::SharedBuffer();
+            }
+        }
+        if (!--req->tasksLeft) {
+            req->done->post();
+        }
+    }
+};
+
 } //namespace
 
 /// Explorer server backend, gets callback on status update and returns json messages for server
@@ -102,7 +224,7 @@ public:
         _nodeBackend(node.get_Processor()),
         _statusDirty(true),
         _nodeIsSyncing(true),
-        _cache(CACHE_DEPTH)
+        _cache(CACHE_DEPTH, CACHE_MAX_BYTES)
     {
         init_helper_fragments();
         _hook = &node.m_Cfg.m_Observer;
@@ -111,6 +233,10 @@ public:
     }
 
     virtual ~Adapter() {
+        if (!_blocksRequests.empty()) {
+            // the render tasks refer to the requests and post their events
+            _nodeBackend.get_TaskProcessor().Flush(0);
+        }
         if (_nextHook) *_hook = _nextHook;
     }
 
@@ -149,9 +275,8 @@ private:
 
     void OnRolledBack(const Block::SystemState::ID& id) override {
 
-        auto& blocks = _cache.blocks;
-
-        blocks.erase(blocks.lower_bound(id.m_Height), blocks.end());
+        _cache.erase_from(id.m_Height);
+        _generation++; // blocks rendered before this point must not be cached
 
         if (_nextHook) _nextHook->OnRolledBack(id);
     }
@@ -210,185 +335,309 @@ private:
         return true;
     }
 
-    bool extract_block_from_row(json& out, uint64_t row) {
+    bool extract_block_data(BlockData& out, uint64_t row) {
         NodeDB& db = _nodeBackend.get_DB();
 
-        Block::SystemState::Full blockState;
-		Block::SystemState::ID id;
-		Block::Body block;
-		bool ok = true;
-
         try {
-            db.get_State(row, blockState);
-			blockState.get_ID(id);
+            db.get_State(row, out.state);
+            out.state.get_ID(out.id);
 
-			NodeDB::StateID sid;
-			sid.m_Row = row;
-			sid.m_Height = id.m_Height;
-			_nodeBackend.ExtractBlockWithExtra(block, sid);
+            NodeDB::StateID sid;
+            sid.m_Row = row;
+            sid.m_Height = out.id.m_Height;
+            _nodeBackend.ExtractBlockWithExtra(out.body, sid);
 
-		} catch (...) {
-            ok = false;
+        } catch (...) {
+            return false;
         }
+        return true;
+    }
 
-
-        if (ok) {
-            char buf[80];
-
-            json inputs = json::array();
-            for (const auto &v : block.m_vInputs) {
-                inputs.push_back(
-                json{
-                    {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
-                    {"maturity",   v->m_Maturity}
-                }
-                );
-            }
-
-            json outputs = json::array();
-            for (const auto &v : block.m_vOutputs) {
-                outputs.push_back(
-                json{
-                    {"commitment", uint256_to_hex(buf, v->m_Commitment.m_X)},
-                    {"maturity",   v->m_Maturity},
-                    {"coinbase",   v->m_Coinbase},
-                    {"incubation", v->m_Incubation}
-                }
-                );
-            }
-
-            json kernels = json::array();
-            for (const auto &v : block.m_vKernels) {
-                Merkle::Hash kernelID;
-                v->get_ID(kernelID);
-                kernels.push_back(
-                    json{
-                        {"id", hash_to_hex(buf, kernelID)},
-                        {"excess", uint256_to_hex(buf, v->m_Commitment.m_X)},
-                        {"minHeight", v->m_Height.m_Min},
-                        {"maxHeight", v->m_Height.m_Max},
-                        {"fee", v->m_Fee}
-                    }
-                );
-            }
-
-            out = json{
-                {"found",      true},
-                {"timestamp",  blockState.m_TimeStamp},
-                {"height",     blockState.m_Height},
-                {"hash",       hash_to_hex(buf, id.m_Hash)},
-                {"prev",       hash_to_hex(buf, blockState.m_Prev)},
-                {"difficulty", blockState.m_PoW.m_Difficulty.ToFloat()},
-                {"chainwork",  uint256_to_hex(buf, blockState.m_ChainWork)},
-                {"subsidy",    Rules::get_Emission(blockState.m_Height)},
-                {"inputs",     inputs},
-                {"outputs",    outputs},
-                {"kernels",    kernels}
-            };
-
-            LOG_DEBUG() << out;
+    void refresh_current_height() {
+        if (_statusDirty) {
+            const auto &cursor = _nodeBackend.m_Cursor;
+            _cache.currentHeight = cursor.m_Sid.m_Height;
+            _cache.lowHorizon = _nodeBackend.m_Extra.m_LoHorizon;
         }
-        return ok;
     }
 
-    bool extract_block(json& out, Height height, uint64_t& row, uint64_t* prevRow) {
-        bool ok = true;
-        if (row == 0) {
-            ok = extract_row(height, row, prevRow);
-        } else if (prevRow != 0) {
-            *prevRow = row;
-            if (!_nodeBackend.get_DB().get_Prev(*prevRow)) {
-                *prevRow = 0;
-            }
-        }
-        return ok && extract_block_from_row(out, row);
+    bool block_not_found(io::SerializedMsg& out, Height height) {
+        return serialize_json_msg(out, _packer, json{ { "found", false}, {"height", height } });
     }
 
-    bool get_block_impl(io::SerializedMsg& out, uint64_t height, uint64_t& row, uint64_t* prevRow) {
-        if (_cache.get_block(out, height)) {
-            if (prevRow && row > 0) {
-                extract_row(height, row, prevRow);
-            }
+    bool get_block_impl(io::SerializedMsg& out, uint64_t height) {
+        BlockData b;
+        if (_cache.get_block(b.rendered, height)) {
+            out.push_back(b.rendered);
             return true;
         }
 
-        if (_statusDirty) {
-            const auto &cursor = _nodeBackend.m_Cursor;
-            _cache.currentHeight = cursor.m_Sid.m_Height;
-            _cache.lowHorizon = _nodeBackend.m_Extra.m_LoHorizon;
-        }
+        refresh_current_height();
 
-        io::SharedBuffer body;
-        bool blockAvailable = (/*height >= _cache.lowHorizon && */height <= _cache.currentHeight);
-        if (blockAvailable) {
-            json j;
-            if (!extract_block(j, height, row, prevRow)) {
-                blockAvailable = false;
-            } else {
-                _sm.clear();
-                if (serialize_json_msg(_sm, _packer, j)) {
-                    body = io::normalize(_sm, false);
-                    _cache.put_block(height, body);
-                } else {
-                    return false;
-                }
-                _sm.clear();
-            }
+        uint64_t row = 0;
+        if (/*height < _cache.lowHorizon || */height > _cache.currentHeight || !extract_row(height, row, 0) || !extract_block_data(b, row)) {
+            return block_not_found(out, height);
         }
 
-        if (blockAvailable) {
-            out.push_back(body);
-            return true;
-        }
+        // a single block is cheap enough to be rendered right here
+        if (!render_block(b.rendered, _packer, b)) return false;
+        _cache.put_block(height, b.rendered);
 
-        return serialize_json_msg(out, _packer, json{ { "found", false}, {"height", height } });
+        out.push_back(b.rendered);
+        return true;
     }
 
     bool get_block(io::SerializedMsg& out, uint64_t height) override {
-        uint64_t row=0;
-        return get_block_impl(out, height, row, 0);
+        return get_block_impl(out, height);
     }
 
     bool get_block_by_hash(io::SerializedMsg& out, const ByteBuffer& hash) override {
         NodeDB& db = _nodeBackend.get_DB();
 
         Height height = db.FindBlock(hash);
-        uint64_t row = 0;
 
-        return get_block_impl(out, height, row, 0);
+        return get_block_impl(out, height);
     }
 
     bool get_block_by_kernel(io::SerializedMsg& out, const ByteBuffer& key) override {
         NodeDB& db = _nodeBackend.get_DB();
 
         Height height = db.FindKernel(key);
-        uint64_t row = 0;
 
-        return get_block_impl(out, height, row, 0);
+        return get_block_impl(out, height);
     }
 
-    bool get_blocks(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) override {
+    void get_blocks(uint64_t startHeight, uint64_t n, Callback&& callback) override {
         static const uint64_t maxElements = 1500;
         if (n > maxElements) n = maxElements;
         else if (n==0) n=1;
-        Height endHeight = startHeight + n - 1;
-        out.push_back(_leftBrace);
+
+        refresh_current_height();
+
+        auto req = std::make_shared<BlocksRequest>();
+        req->endHeight = startHeight + n - 1;
+        req->generation = _generation;
+        req->callback = std::move(callback);
+
+        // blocks in descending order, missing ones are extracted walking the active chain backwards
+        NodeDB& db = _nodeBackend.get_DB();
+        req->blocks.resize(n);
         uint64_t row = 0;
-        uint64_t prevRow = 0;
-        for (;;) {
-            bool ok = get_block_impl(out, endHeight, row, &prevRow);
-            if (!ok) return false;
-            if (endHeight == startHeight) {
+        for (uint64_t i = 0; i < n; i++) {
+            Height height = req->endHeight - i;
+            BlockData& b = req->blocks[i];
+            if (!_cache.get_block(b.rendered, height) && height <= _cache.currentHeight) {
+                if (!row) {
+                    extract_row(height, row, 0);
+                }
+                if (row && extract_block_data(b, row)) {
+                    req->toRender.push_back(&b);
+                }
+            }
+            if (row && !db.get_Prev(row)) {
+                row = 0;
+            }
+        }
+
+        // the response is always completed asynchronously, even if everything is cached
+        uint64_t id = ++_lastRequestId;
+        req->done = io::AsyncEvent::create(io::Reactor::get_Current(), [this, id]() { on_blocks_rendered(id); });
+        _blocksRequests[id] = req;
+
+        NodeProcessor::Task::Processor& tp = _nodeBackend.get_TaskProcessor();
+        uint32_t nTasks = static_cast<uint32_t>(std::min<size_t>(tp.get_Threads(), req->toRender.size()));
+        if (!nTasks) {
+            req->done->post();
+            return;
+        }
+
+        req->tasksLeft = nTasks;
+        for (uint32_t i = 0; i < nTasks; i++) {
+            tp.Push(std::make_unique<BlockRenderTask>(req));
+        }
+    }
+
+    /// Called on the reactor thread once all the blocks of the request are rendered
+    void on_blocks_rendered(uint64_t id) {
+        auto it = _blocksRequests.find(id);
+        if (it == _blocksRequests.end()) return;
+        std::shared_ptr<BlocksRequest> req = std::move(it->second);
+        _blocksRequests.erase(it);
+
+        io::SerializedMsg out;
+        bool ok = true;
+        for (BlockData* b : req->toRender) {
+            if (b->rendered.empty()) {
+                ok = false;
                 break;
             }
-            out.push_back(_comma);
-            row = prevRow;
-            --endHeight;
+            if (req->generation == _generation) {
+                _cache.put_block(b->id.m_Height, b->rendered);
+            }
+        }
+
+        if (ok) {
+            out.push_back(_leftBrace);
+            for (size_t i = 0; i < req->blocks.size(); i++) {
+                if (i) out.push_back(_comma);
+                if (!req->blocks[i].rendered.empty()) {
+                    out.push_back(req->blocks[i].rendered);
+                } else if (!block_not_found(out, req->endHeight - i)) {
+                    ok = false;
+                    break;
+                }
+            }
+            out.push_back(_rightBrace);
+        }
+
+        req->callback(ok, out);
+    }
+
+    /// Rows of the active states in [startHeight, endHeight], walking the chain backwards from the top
+    bool extract_rows(std::vector<uint64_t>& rows, Height startHeight, Height endHeight) {
+        rows.resize(endHeight - startHeight + 1);
+        uint64_t row = 0;
+        if (!extract_row(endHeight, row, 0)) return false;
+
+        NodeDB& db = _nodeBackend.get_DB();
+        for (size_t i = rows.size(); ; ) {
+            rows[--i] = row;
+            if (!i) break;
+            if (!db.get_Prev(row)) return false;
         }
-        out.push_back(_rightBrace);
         return true;
     }
 
+    /// Clips the requested range to the active chain, returns false if nothing is left
+    bool clip_range(Height& startHeight, Height& endHeight, uint64_t n, uint64_t maxElements) {
+        if (n > maxElements) n = maxElements;
+        else if (n==0) n=1;
+        refresh_current_height();
+        if (startHeight < Rules::HeightGenesis) startHeight = Rules::HeightGenesis;
+        endHeight = std::min(startHeight + n - 1, _cache.currentHeight);
+        return startHeight <= endHeight;
+    }
+
+    bool get_headers(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) override {
+        Height endHeight;
+        std::vector<uint64_t> rows;
+        if (!clip_range(startHeight, endHeight, n, 10000) || !extract_rows(rows, startHeight, endHeight)) {
+            return true; // empty stream
+        }
+
+        NodeDB& db = _nodeBackend.get_DB();
+        char buf[80];
+        for (uint64_t row : rows) {
+            Block::SystemState::Full s;
+            Block::SystemState::ID id;
+            db.get_State(row, s);
+            s.get_ID(id);
+
+            if (!serialize_json_msg(out, _packer, json{
+                {"height",     s.m_Height},
+                {"hash",       hash_to_hex(buf, id.m_Hash)},
+                {"prev",       hash_to_hex(buf, s.m_Prev)},
+                {"timestamp",  s.m_TimeStamp},
+                {"difficulty", s.m_PoW.m_Difficulty.ToFloat()},
+                {"chainwork",  uint256_to_hex(buf, s.m_ChainWork)}
+            })) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool get_kernels(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) override {
+        Height endHeight;
+        std::vector<uint64_t> rows;
+        if (!clip_range(startHeight, endHeight, n, 1500) || !extract_rows(rows, startHeight, endHeight)) {
+            return true;
+        }
+
+        char buf[80];
+        for (uint64_t row : rows) {
+            BlockData b;
+            if (!extract_block_data(b, row)) return false;
+
+            for (const auto &v : b.body.m_vKernels) {
+                Merkle::Hash kernelID;
+                v->get_ID(kernelID);
+                if (!serialize_json_msg(out, _packer, json{
+                    {"height",    b.id.m_Height},
+                    {"id",        hash_to_hex(buf, kernelID)},
+                    {"excess",    uint256_to_hex(buf, v->m_Commitment.m_X)},
+                    {"minHeight", v->m_Height.m_Min},
+                    {"maxHeight", v->m_Height.m_Max},
+                    {"fee",       v->m_Fee}
+                })) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool get_utxo(io::SerializedMsg& out, const ByteBuffer& commitment) override {
+        struct Traveler :public UtxoTree::ITraveler {
+            json utxos = json::array();
+
+            virtual bool OnLeaf(const RadixTree::Leaf& x) override {
+                const UtxoTree::MyLeaf& v = Cast::Up<UtxoTree::MyLeaf>(x);
+                UtxoTree::Key::Data d;
+                d = v.m_Key;
+
+                char buf[80];
+                utxos.push_back(json{
+                    {"commitment", uint256_to_hex(buf, d.m_Commitment.m_X)},
+                    {"maturity",   d.m_Maturity},
+                    {"count",      v.get_Count()}
+                });
+                return true;
+            }
+        } t;
+
+        if (commitment.size() > ECC::uintBig::nBytes) return false;
+
+        if (!_nodeBackend.IsFastSync()) {
+            UtxoTree::Key::Data d;
+            d.m_Commitment.m_X = Zero;
+            std::copy(commitment.begin(), commitment.end(), d.m_Commitment.m_X.m_pData + ECC::uintBig::nBytes - commitment.size());
+
+            // the parity of y isn't rendered by the explorer, so both points are looked for
+            for (uint8_t y = 0; y < 2; y++) {
+                UtxoTree::Key kMin, kMax;
+                d.m_Commitment.m_Y = y;
+                d.m_Maturity = 0;
+                kMin = d;
+                d.m_Maturity = Height(-1);
+                kMax = d;
+
+                t.m_pBound[0] = kMin.V.m_pData;
+                t.m_pBound[1] = kMax.V.m_pData;
+                _nodeBackend.get_Utxos().Traverse(t);
+            }
+        }
+
+        bool found = !t.utxos.empty();
+        return serialize_json_msg(out, _packer, json{ {"found", found}, {"utxos", std::move(t.utxos)} });
+    }
+
+    bool get_mempool(io::SerializedMsg& out) override {
+        uint64_t count = 0, size = 0;
+        Amount fee = 0;
+        for (const auto& x : _node.get_TxPool().m_setProfit) {
+            count++;
+            size += x.m_nSize;
+            fee += AmountBig::get_Lo(x.m_Fee);
+        }
+
+        return serialize_json_msg(out, _packer, json{
+            {"count", count},
+            {"size",  size},
+            {"fee",   fee}
+        });
+    }
+
     HttpMsgCreator _packer;
 
     // node db interface
@@ -410,6 +659,13 @@ private:
 
     ResponseCache _cache;
 
+    // incremented on rollback, so that the blocks in flight aren't cached
+    uint64_t _generation=0;
+
+    // blocks requests being rendered
+    std::map<uint64_t, std::shared_ptr<BlocksRequest>> _blocksRequests;
+    uint64_t _lastRequestId=0;
+
     io::SerializedMsg _sm;
 };
 
@@ -14,6 +14,7 @@
 
 #include "utility/io/buffer.h"
 #include "utility/common.h"
+#include <functional>
 
 namespace beam {
 
@@ -36,7 +37,23 @@ struct IAdapter {
 
     virtual bool get_block_by_kernel(io::SerializedMsg& out, const ByteBuffer& key) = 0;
 
-    virtual bool get_blocks(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) = 0;
+    /// Completion of an asynchronous request, called on the reactor thread. ok is false on internal error
+    using Callback = std::function<void(bool ok, io::SerializedMsg& body)>;
+
+    /// Extracts the blocks on the calling (reactor) thread and renders them off it.
+    /// The callback is never invoked from within this call
+    virtual void get_blocks(uint64_t startHeight, uint64_t n, Callback&& callback) = 0;
+
+    /// Range endpoints, append NDJSON (one object per line) in ascending height order.
+    /// The range is clipped to the active chain. The server streams large ranges calling these batch by batch
+    virtual bool get_headers(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) = 0;
+
+    virtual bool get_kernels(io::SerializedMsg& out, uint64_t startHeight, uint64_t n) = 0;
+
+    /// Unspent outputs with the given commitment (x coordinate, big-endian)
+    virtual bool get_utxo(io::SerializedMsg& out, const ByteBuffer& commitment) = 0;
+
+    virtual bool get_mempool(io::SerializedMsg& out) = 0;
 };
 
 IAdapter::Ptr create_adapter(Node& node);
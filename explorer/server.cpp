@@ -30,8 +30,17 @@ static const uint64_t ACL_REFRESH_TIMER = 2;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5555;
 
+static const char* CONTENT_TYPE_NDJSON = "application/x-ndjson";
+
+// range responses are produced this many heights at a time, while the connection has less than STREAM_MAX_UNSENT bytes queued
+static const uint64_t STREAM_BATCH = 100;
+static const size_t STREAM_MAX_UNSENT = 256 * 1024;
+static const unsigned STREAM_RETRY_INTERVAL = 10;
+static const uint64_t MAX_HEADERS = 10000;
+static const uint64_t MAX_KERNEL_HEIGHTS = 1500;
+
 enum Dirs {
-    DIR_STATUS, DIR_BLOCK, DIR_BLOCKS
+    DIR_STATUS, DIR_BLOCK, DIR_BLOCKS, DIR_HEADERS, DIR_KERNELS, DIR_UTXO, DIR_MEMPOOL
     // etc
 };
 
@@ -48,6 +57,7 @@ Server::Server(IAdapter& adapter, io::Reactor& reactor, io::Address bindAddress,
 {
     _timers.set_timer(SERVER_RESTART_TIMER, 0, BIND_THIS_MEMFN(start_server));
     _timers.set_timer(ACL_REFRESH_TIMER, ACL_REFRESH_INTERVAL, BIND_THIS_MEMFN(refresh_acl));
+    _streamTimer = io::Timer::create(reactor);
 }
 
 void Server::start_server() {
@@ -112,11 +122,20 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg) {
     const std::string& path = msg.msg->get_path();
 
     static const std::map<std::string_view, int> dirs {
-        { "status", DIR_STATUS }, { "block", DIR_BLOCK }, { "blocks", DIR_BLOCKS }
+        { "status", DIR_STATUS }, { "block", DIR_BLOCK }, { "blocks", DIR_BLOCKS },
+        { "headers", DIR_HEADERS }, { "kernels", DIR_KERNELS }, { "utxo", DIR_UTXO }, { "mempool", DIR_MEMPOOL }
     };
 
     const HttpConnection::Ptr& conn = it->second;
 
+    if (_pending.count(id)) {
+        // pipelined request while the previous response is in flight, the order couldn't be kept
+        LOG_DEBUG() << STS << "-peer " << io::Address::from_u64(id) << " : request while busy";
+        conn->shutdown();
+        _connections.erase(it);
+        return false;
+    }
+
     bool (Server::*func)(const HttpConnection::Ptr&) = 0;
 
     if (_currentUrl.parse(path, dirs)) {
@@ -130,6 +149,18 @@ bool Server::on_request(uint64_t id, const HttpMsgReader::Message& msg) {
             case DIR_BLOCKS:
                 func = &Server::send_blocks;
                 break;
+            case DIR_HEADERS:
+                func = &Server::send_headers;
+                break;
+            case DIR_KERNELS:
+                func = &Server::send_kernels;
+                break;
+            case DIR_UTXO:
+                func = &Server::send_utxo;
+                break;
+            case DIR_MEMPOOL:
+                func = &Server::send_mempool;
+                break;
             default:
                 break;
         }
@@ -199,13 +230,170 @@ bool Server::send_blocks(const HttpConnection::Ptr& conn) {
     if (start <= 0 || n < 0) {
         return send(conn, 400, "Bad request");
     }
-    if (!_backend.get_blocks(_body, start, n)) {
-        return send(conn, 500, "Internal error #3");
+
+    // rendered off the reactor thread, the connection is kept until the response is sent
+    uint64_t id = conn->id();
+    _pending.insert(id);
+    _backend.get_blocks(start, n, [this, id](bool ok, io::SerializedMsg& body) { on_blocks(id, ok, body); });
+    return true;
+}
+
+void Server::on_blocks(uint64_t id, bool ok, io::SerializedMsg& body) {
+    _pending.erase(id);
+
+    auto it = _connections.find(id);
+    if (it == _connections.end()) return; // disconnected meanwhile
+
+    bool keepalive;
+    if (ok) {
+        _body.swap(body);
+        keepalive = send(it->second, 200, "OK");
+    } else {
+        keepalive = send(it->second, 500, "Internal error #3");
+    }
+
+    if (!keepalive) {
+        it->second->shutdown();
+        _connections.erase(it);
+    }
+}
+
+bool Server::send_headers(const HttpConnection::Ptr& conn) {
+    auto start = _currentUrl.get_int_arg("height", 0);
+    auto n = _currentUrl.get_int_arg("n", 0);
+    if (start <= 0 || n < 0) {
+        return send(conn, 400, "Bad request");
+    }
+    return start_stream(conn, DIR_HEADERS, start, std::min<uint64_t>(std::max<int64_t>(n, 1), MAX_HEADERS));
+}
+
+bool Server::send_kernels(const HttpConnection::Ptr& conn) {
+    auto start = _currentUrl.get_int_arg("height", 0);
+    auto n = _currentUrl.get_int_arg("n", 0);
+    if (start <= 0 || n < 0) {
+        return send(conn, 400, "Bad request");
+    }
+    return start_stream(conn, DIR_KERNELS, start, std::min<uint64_t>(std::max<int64_t>(n, 1), MAX_KERNEL_HEIGHTS));
+}
+
+bool Server::start_stream(const HttpConnection::Ptr& conn, int dir, uint64_t start, uint64_t n) {
+    static const HeaderPair headers[] = {
+        { "Content-Type", CONTENT_TYPE_NDJSON },
+        { "Transfer-Encoding", "chunked" }
+    };
+
+    if (!_msgCreator.create_response(_headers, 200, "OK", headers, sizeof(headers) / sizeof(HeaderPair), 1) || !conn->write_msg(_headers)) {
+        _headers.clear();
+        return false;
+    }
+    _headers.clear();
+
+    uint64_t id = conn->id();
+    Stream& s = _streams[id];
+    s.dir = dir;
+    s.next = start;
+    s.end = start + n - 1;
+
+    // the rest of the connection's requests wait for the stream to end
+    _pending.insert(id);
+
+    _streamTimer->start(0, false, BIND_THIS_MEMFN(on_stream_timer));
+    return true;
+}
+
+void Server::on_stream_timer() {
+    bool bWaiting = false;
+
+    for (auto it = _streams.begin(); it != _streams.end(); ) {
+        uint64_t id = it->first;
+        Stream& s = it->second;
+
+        auto itConn = _connections.find(id);
+        if (itConn == _connections.end()) {
+            // disconnected meanwhile
+            _pending.erase(id);
+            it = _streams.erase(it);
+            continue;
+        }
+
+        const HttpConnection::Ptr& conn = itConn->second;
+        if (conn->get_Unsent() > STREAM_MAX_UNSENT) {
+            bWaiting = true;
+            ++it;
+            continue;
+        }
+
+        uint64_t n = std::min(STREAM_BATCH, s.end - s.next + 1);
+        bool ok = (DIR_HEADERS == s.dir) ?
+            _backend.get_headers(_body, s.next, n) :
+            _backend.get_kernels(_body, s.next, n);
+        s.next += n;
+
+        bool bLast = (s.next > s.end);
+        if (ok) {
+            ok = write_chunk(conn, bLast);
+        }
+        _body.clear();
+
+        if (!ok) {
+            // the status is already sent, the only way to report is to break the response
+            LOG_ERROR() << STS << "range response failed, peer " << io::Address::from_u64(id);
+            conn->shutdown();
+            _connections.erase(itConn);
+            bLast = true;
+        }
+
+        if (bLast) {
+            _pending.erase(id);
+            it = _streams.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!_streams.empty()) {
+        _streamTimer->start(bWaiting ? STREAM_RETRY_INTERVAL : 0, false, BIND_THIS_MEMFN(on_stream_timer));
+    }
+}
+
+bool Server::write_chunk(const HttpConnection::Ptr& conn, bool bLast) {
+    size_t bodySize = 0;
+    for (const auto& f : _body) { bodySize += f.size; }
+
+    char buf[32];
+    if (bodySize) {
+        int n = snprintf(buf, sizeof(buf), "%zx\r\n", bodySize);
+        _body.insert(_body.begin(), io::SharedBuffer(buf, n));
+        _body.push_back(io::SharedBuffer("\r\n", 2));
+    }
+    if (bLast) {
+        _body.push_back(io::SharedBuffer("0\r\n\r\n", 5));
+    }
+
+    return _body.empty() || conn->write_msg(_body);
+}
+
+bool Server::send_utxo(const HttpConnection::Ptr& conn) {
+    static const size_t MAX_COMMITMENT_SIZE = 32; // x coordinate
+
+    ByteBuffer commitment;
+    if (!_currentUrl.get_hex_arg("commitment", commitment) || commitment.empty() || commitment.size() > MAX_COMMITMENT_SIZE) {
+        return send(conn, 400, "Bad request");
+    }
+    if (!_backend.get_utxo(_body, commitment)) {
+        return send(conn, 500, "Internal error #6");
+    }
+    return send(conn, 200, "OK");
+}
+
+bool Server::send_mempool(const HttpConnection::Ptr& conn) {
+    if (!_backend.get_mempool(_body)) {
+        return send(conn, 500, "Internal error #7");
     }
     return send(conn, 200, "OK");
 }
 
-bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message) {
+bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message, const char* contentType) {
     assert(conn);
 
     size_t bodySize = 0;
@@ -218,7 +406,7 @@ bool Server::send(const HttpConnection::Ptr& conn, int code, const char* message
         0, //headers,
         0, //sizeof(headers) / sizeof(HeaderPair),
         1,
-        "application/json",
+        contentType,
         bodySize
     );
 
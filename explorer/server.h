@@ -16,6 +16,7 @@
 #include "http/http_msg_creator.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
+#include "utility/io/timer.h"
 #include "utility/helpers.h"
 #include <string_view>
 #include <set>
@@ -52,7 +53,23 @@ private:
     bool send_status(const HttpConnection::Ptr& conn);
     bool send_block(const HttpConnection::Ptr& conn);
     bool send_blocks(const HttpConnection::Ptr& conn);
-    bool send(const HttpConnection::Ptr& conn, int code, const char* message);
+    void on_blocks(uint64_t id, bool ok, io::SerializedMsg& body);
+    bool send_headers(const HttpConnection::Ptr& conn);
+    bool send_kernels(const HttpConnection::Ptr& conn);
+    bool send_utxo(const HttpConnection::Ptr& conn);
+    bool send_mempool(const HttpConnection::Ptr& conn);
+    bool send(const HttpConnection::Ptr& conn, int code, const char* message, const char* contentType = "application/json");
+
+    /// Range responses are sent chunked, one batch of heights at a time
+    bool start_stream(const HttpConnection::Ptr& conn, int dir, uint64_t start, uint64_t n);
+    void on_stream_timer();
+    bool write_chunk(const HttpConnection::Ptr& conn, bool bLast);
+
+    struct Stream {
+        int dir;
+        uint64_t next;
+        uint64_t end;
+    };
 
     HttpMsgCreator _msgCreator;
     IAdapter& _backend;
@@ -61,6 +78,9 @@ private:
     io::Address _bindAddress;
     io::TcpServer::Ptr _server;
     std::map<uint64_t, HttpConnection::Ptr> _connections;
+    std::set<uint64_t> _pending; // connections waiting for an asynchronous response
+    std::map<uint64_t, Stream> _streams;
+    io::Timer::Ptr _streamTimer;
     HttpUrl _currentUrl;
     io::SerializedMsg _headers;
     io::SerializedMsg _body;
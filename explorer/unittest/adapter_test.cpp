@@ -13,12 +13,30 @@
 // limitations under the License.
 
 #include "explorer/adapter.h"
+#include "explorer/server.h"
 #include "node/node.h"
+#include "core/treasury.h"
 #include "utility/logger.h"
+#include "nlohmann/json.hpp"
 #include <future>
 #include <boost/filesystem.hpp>
 #include <wallet/unittests/util.h>
 
+int g_TestsFailed = 0;
+
+void TestFailed(const char* szExpr, uint32_t nLine)
+{
+    printf("Test failed! Line=%u, Expression: %s\n", nLine, szExpr);
+    g_TestsFailed++;
+    fflush(stdout);
+}
+
+#define verify_test(x) \
+    do { \
+        if (!(x)) \
+            TestFailed(#x, __LINE__); \
+    } while (false)
+
 namespace beam {
 
 struct WaitHandle {
@@ -102,6 +120,262 @@ int test_adapter(int seconds) {
     return 0;
 }
 
+/// Minimal treasury, so that the node can mine on its own
+void make_treasury(ByteBuffer& out) {
+    ECC::uintBig seed;
+    ECC::GenRandom(seed);
+    Key::IKdf::Ptr pKdf;
+    ECC::HKdf::Create(pKdf, seed);
+
+    PeerID pid;
+    ECC::Scalar::Native sk;
+    Treasury::get_ID(*pKdf, pid, sk);
+
+    Treasury tres;
+    Treasury::Parameters pars;
+    pars.m_Bursts = 1;
+    Treasury::Entry* pE = tres.CreatePlan(pid, Rules::get().Emission.Value0 / 5, pars);
+
+    pE->m_pResponse.reset(new Treasury::Response);
+    uint64_t nIndex = 1;
+    verify_test(pE->m_pResponse->Create(pE->m_Request, *pKdf, nIndex));
+
+    Treasury::Data data;
+    tres.Build(data);
+
+    Serializer ser;
+    ser & data;
+    ser.swap_buf(out);
+
+    ECC::Hash::Processor() << Blob(out) >> Rules::get().TreasuryChecksum;
+}
+
+/// Mines blocks directly into the node, no network
+void mine_blocks(Node& node, Height n) {
+    for (Height i = 0; i < n; i++) {
+        TxPool::Fluff txPool;
+        NodeProcessor::BlockContext bc(txPool, 0, *node.m_Keys.m_pMiner, *node.m_Keys.m_pMiner);
+        verify_test(node.get_Processor().GenerateNewBlock(bc));
+
+        Block::SystemState::ID id;
+        bc.m_Hdr.get_ID(id);
+        node.get_Processor().OnState(bc.m_Hdr, PeerID());
+        node.get_Processor().OnBlock(id, bc.m_BodyP, bc.m_BodyE, PeerID());
+        node.get_Processor().TryGoUp();
+    }
+}
+
+/// Requests the blocks and runs the reactor until the response is ready
+nlohmann::json get_blocks(io::Reactor& reactor, explorer::IAdapter& adapter, uint64_t start, uint64_t n) {
+    bool called = false;
+    bool ok = false;
+    io::SharedBuffer body;
+
+    adapter.get_blocks(start, n, [&](bool ok_, io::SerializedMsg& msg) {
+        called = true;
+        ok = ok_;
+        body = io::normalize(msg, true);
+        reactor.stop();
+    });
+    verify_test(!called); // never completed synchronously
+
+    reactor.run();
+    verify_test(called && ok);
+
+    return nlohmann::json::parse(body.data, body.data + body.size);
+}
+
+std::vector<nlohmann::json> parse_ndjson(const char* p, const char* pEnd) {
+    std::vector<nlohmann::json> ret;
+    while (p != pEnd) {
+        const char* pEol = std::find(p, pEnd, '\n');
+        ret.push_back(nlohmann::json::parse(p, pEol));
+        p = (pEol == pEnd) ? pEnd : pEol + 1;
+    }
+    return ret;
+}
+
+std::vector<nlohmann::json> parse_ndjson(const io::SerializedMsg& msg) {
+    io::SharedBuffer buf = io::normalize(msg, true);
+    return parse_ndjson((const char*) buf.data, (const char*) buf.data + buf.size);
+}
+
+void test_ranges(explorer::IAdapter& adapter, const nlohmann::json& blocks, Height hTip) {
+    // blocks are in descending order, [1, hTip]
+    io::SerializedMsg msg;
+    verify_test(adapter.get_headers(msg, 1, hTip + 5)); // clipped to the tip
+    std::vector<nlohmann::json> v = parse_ndjson(msg);
+    verify_test(v.size() == hTip);
+    for (Height h = 1; h <= std::min<Height>(hTip, v.size()); h++) {
+        verify_test(v[h - 1]["height"] == h);
+        verify_test(v[h - 1]["hash"] == blocks[hTip - h]["hash"]);
+    }
+
+    msg.clear();
+    verify_test(adapter.get_kernels(msg, 1, hTip));
+    v = parse_ndjson(msg);
+    size_t nKernels = 0;
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+        const auto& b = *it;
+        for (const auto& k : b["kernels"]) {
+            verify_test(nKernels < v.size() && v[nKernels]["id"] == k["id"] && v[nKernels]["height"] == b["height"]);
+            nKernels++;
+        }
+    }
+    verify_test(nKernels && v.size() == nKernels);
+
+    // past the tip, empty
+    msg.clear();
+    verify_test(adapter.get_headers(msg, hTip + 1, 10));
+    verify_test(msg.empty());
+
+    // utxo lookup by the rendered commitment (hex with the leading zeroes stripped)
+    std::string sComm = blocks[0]["outputs"][0]["commitment"].get<std::string>().substr(2);
+    if (sComm.size() & 1) sComm.insert(sComm.begin(), '0');
+    ByteBuffer comm(sComm.size() / 2);
+    for (size_t i = 0; i < comm.size(); i++) {
+        comm[i] = static_cast<uint8_t>(std::stoi(sComm.substr(i * 2, 2), nullptr, 16));
+    }
+
+    msg.clear();
+    verify_test(adapter.get_utxo(msg, comm));
+    v = parse_ndjson(msg);
+    verify_test(v.size() == 1 && v[0]["found"] == true && v[0]["utxos"].size() == 1);
+
+    msg.clear();
+    verify_test(adapter.get_utxo(msg, ByteBuffer(32, 0x11)));
+    v = parse_ndjson(msg);
+    verify_test(v.size() == 1 && v[0]["found"] == false);
+
+    msg.clear();
+    verify_test(adapter.get_mempool(msg));
+    v = parse_ndjson(msg);
+    verify_test(v.size() == 1 && v[0]["count"] == 0);
+}
+
+/// Sends the raw request, returns what the server sent until the connection is closed or the chunked body is over
+std::string http_request(io::Reactor& reactor, const io::Address& addr, const std::string& request) {
+    std::string response;
+    io::TcpStream::Ptr stream;
+
+    reactor.tcp_connect(addr, 1, [&](uint64_t, io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+        if (errorCode) {
+            reactor.stop();
+            return;
+        }
+        stream = std::move(newStream);
+        stream->enable_read([&](io::ErrorCode what, void* data, size_t size) {
+            if (what) {
+                reactor.stop();
+                return false;
+            }
+            response.append((const char*) data, size);
+            static const std::string sEnd = "\r\n0\r\n\r\n";
+            if (response.size() >= sEnd.size() && !response.compare(response.size() - sEnd.size(), sEnd.size(), sEnd)) {
+                reactor.stop();
+            }
+            return true;
+        });
+        stream->write(request.data(), request.size());
+    });
+
+    reactor.run();
+    return response;
+}
+
+/// Decodes the chunked body, returns false on malformed input
+bool decode_chunked(std::string& body, const std::string& response) {
+    size_t pos = response.find("\r\n\r\n");
+    if (pos == std::string::npos) return false;
+    pos += 4;
+
+    while (true) {
+        size_t eol = response.find("\r\n", pos);
+        if (eol == std::string::npos) return false;
+        size_t n = std::stoul(response.substr(pos, eol - pos), nullptr, 16);
+        pos = eol + 2;
+        if (!n) return true;
+        if (pos + n + 2 > response.size()) return false;
+        body.append(response, pos, n);
+        pos += n + 2;
+    }
+}
+
+void test_server(io::Reactor& reactor, explorer::IAdapter& adapter, Height hTip) {
+    io::Address addr = io::Address::localhost().port(NODE_PORT + 1);
+    explorer::Server server(adapter, reactor, addr, "", {});
+
+    // let it start listening
+    io::Timer::Ptr timer = io::Timer::create(reactor);
+    timer->start(300, false, [&reactor]() { reactor.stop(); });
+    reactor.run();
+
+    // range streamed as chunks
+    std::string response = http_request(reactor, addr, "GET /headers?height=1&n=" + std::to_string(hTip + 300) + " HTTP/1.1\r\n\r\n");
+    verify_test(!response.compare(0, 15, "HTTP/1.1 200 OK"));
+    verify_test(response.find("Transfer-Encoding: chunked") != std::string::npos);
+
+    std::string body;
+    verify_test(decode_chunked(body, response));
+    std::vector<nlohmann::json> v = parse_ndjson(body.data(), body.data() + body.size());
+    verify_test(v.size() == hTip);
+    verify_test(!v.empty() && v.back()["height"] == hTip);
+
+    // malformed input is the client's fault
+    response = http_request(reactor, addr, "GET /utxo?commitment=" + std::string(66, 'a') + " HTTP/1.1\r\n\r\n");
+    verify_test(!response.compare(0, 12, "HTTP/1.1 400"));
+    response = http_request(reactor, addr, "GET /utxo?commitment=zz HTTP/1.1\r\n\r\n");
+    verify_test(!response.compare(0, 12, "HTTP/1.1 400"));
+}
+
+void test_endpoints() {
+    cleanup_files();
+
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    Node node;
+    node.m_Cfg.m_sPathLocal = FILENAME;
+    node.m_Cfg.m_VerificationThreads = 2;
+    make_treasury(node.m_Cfg.m_Treasury);
+
+    ECC::uintBig seed;
+    ECC::Hash::Processor() << Blob("xxx", 3) >> seed;
+    node.m_Keys.InitSingleKey(seed);
+
+    explorer::IAdapter::Ptr adapter = explorer::create_adapter(node);
+    node.Initialize();
+
+    const Height hTip = 20;
+    mine_blocks(node, hTip);
+    verify_test(node.get_Processor().m_Cursor.m_ID.m_Height == hTip);
+
+    // rendered on the task processor, in descending order, past the tip are not found
+    nlohmann::json j = get_blocks(*reactor, *adapter, hTip - 9, 12);
+    verify_test(j.is_array() && j.size() == 12);
+    for (size_t i = 0; i < j.size(); i++) {
+        Height h = hTip + 2 - i;
+        verify_test(j[i]["height"] == h);
+        verify_test(j[i]["found"] == (h <= hTip));
+    }
+
+    // now from the cache, mixed with the blocks not rendered yet
+    nlohmann::json j2 = get_blocks(*reactor, *adapter, 1, hTip);
+    verify_test(j2.size() == hTip);
+    for (size_t i = 0; i < 12; i++) {
+        if (j[i]["found"]) {
+            verify_test(j2[hTip - j[i]["height"].get<Height>()] == j[i]);
+        }
+    }
+    verify_test(j2.back()["height"] == 1);
+
+    test_ranges(*adapter, j2, hTip);
+    test_server(*reactor, *adapter, hTip);
+
+    adapter.reset();
+    cleanup_files();
+}
+
 } //namespace
 
 int main(int argc, char* argv[]) {
@@ -133,6 +407,9 @@ int main(int argc, char* argv[]) {
     }
 
     int ret = test_adapter(seconds);
-    return ret;
+    if (ret) return ret;
+
+    test_endpoints();
+    return g_TestsFailed ? -1 : 0;
 }
 
@@ -36,13 +36,18 @@ namespace beam {
 #define TblStates_CountNextF	"CountNextFunctional"
 #define TblStates_PoW			"PoW"
 #define TblStates_Mmr			"Mmr"
-#define TblStates_BodyP			"Perishable"
-#define TblStates_BodyE			"Ethernal"
+#define TblStates_BodyP			"Perishable" // moved to TblBlocks since ver 19
+#define TblStates_BodyE			"Ethernal" // moved to TblBlocks since ver 19
 #define TblStates_Peer			"Peer"
 #define TblStates_ChainWork		"ChainWork"
 #define TblStates_Txos			"Txos"
 #define TblStates_Extra			"Extra"
 
+#define TblBlocks				"Blocks"
+#define TblBlocks_Row			"Row"
+#define TblBlocks_BodyP			"Perishable"
+#define TblBlocks_BodyE			"Ethernal"
+
 #define TblTips					"Tips"
 #define TblTipsReachable		"TipsReachable"
 #define TblTips_Height			"Height"
@@ -280,7 +285,7 @@ void NodeDB::Open(const char* szPath)
 		bCreate = !rs.Step();
 	}
 
-	const uint64_t nVersionTop = 17;
+	const uint64_t nVersionTop = 19;
 
 	Transaction t(*this);
 
@@ -293,7 +298,18 @@ void NodeDB::Open(const char* szPath)
 	{
 		uint64_t nVer = ParamIntGetDef(ParamID::DbVer);
 		if (nVer < nVersionTop)
-			throw NodeDBUpgradeException("Node upgrade is not supported. Please, remove node.db and tempmb files");
+		{
+			if (nVer < 17)
+				throw NodeDBUpgradeException("Node upgrade is not supported. Please, remove node.db and tempmb files");
+
+			if (nVer < 18)
+				CreateIndexStatesHash();
+
+			if (nVer < 19)
+				MoveBlocksFromStates();
+
+			ParamSet(ParamID::DbVer, &nVersionTop, NULL);
+		}
 	}
 
 	t.Commit();
@@ -329,8 +345,6 @@ void NodeDB::Create()
 		"[" TblStates_CountNextF	"] INTEGER NOT NULL,"
 		"[" TblStates_PoW			"] BLOB,"
 		"[" TblStates_Mmr			"] BLOB,"
-		"[" TblStates_BodyP			"] BLOB,"
-		"[" TblStates_BodyE			"] BLOB,"
 		"[" TblStates_Peer			"] BLOB,"
 		"[" TblStates_ChainWork		"] BLOB,"
 		"[" TblStates_Txos			"] INTEGER,"
@@ -340,6 +354,8 @@ void NodeDB::Create()
 
 	ExecQuick("CREATE INDEX [Idx" TblStates "Wrk] ON [" TblStates "] ([" TblStates_ChainWork "]);");
 	ExecQuick("CREATE INDEX [Idx" TblStates TblStates_Txos "] ON [" TblStates "] ([" TblStates_Txos "]);");
+	CreateIndexStatesHash();
+	CreateTableBlocks();
 
 	ExecQuick("CREATE TABLE [" TblTips "] ("
 		"[" TblTips_Height	"] INTEGER NOT NULL,"
@@ -401,6 +417,34 @@ void NodeDB::CreateTableDummy()
 	ExecQuick("CREATE INDEX [Idx" TblDummy "H] ON [" TblDummy "] ([" TblDummy_SpendHeight "])");
 }
 
+void NodeDB::CreateIndexStatesHash()
+{
+	// The primary key starts with the height, lookup by hash alone would otherwise scan all the states
+	ExecQuick("CREATE INDEX [Idx" TblStates TblStates_Hash "] ON [" TblStates "] ([" TblStates_Hash "],[" TblStates_Height "] DESC);");
+}
+
+void NodeDB::CreateTableBlocks()
+{
+	// Block bodies are kept apart from the states, so that the states table stays compact
+	ExecQuick("CREATE TABLE [" TblBlocks "] ("
+		"[" TblBlocks_Row			"] INTEGER NOT NULL PRIMARY KEY,"
+		"[" TblBlocks_BodyP			"] BLOB,"
+		"[" TblBlocks_BodyE			"] BLOB,"
+		"FOREIGN KEY (" TblBlocks_Row ") REFERENCES " TblStates "(OID))");
+}
+
+void NodeDB::MoveBlocksFromStates()
+{
+	CreateTableBlocks();
+
+	ExecQuick("INSERT INTO " TblBlocks "(" TblBlocks_Row "," TblBlocks_BodyP "," TblBlocks_BodyE ") SELECT rowid," TblStates_BodyP "," TblStates_BodyE " FROM " TblStates
+		" WHERE " TblStates_BodyP " IS NOT NULL OR " TblStates_BodyE " IS NOT NULL");
+
+	ExecQuick("UPDATE " TblStates " SET " TblStates_BodyP "=NULL," TblStates_BodyE "=NULL");
+
+	OnBlocksMoved();
+}
+
 void NodeDB::CreateTableTxos()
 {
 	ExecQuick("CREATE TABLE [" TblTxo "] ("
@@ -820,6 +864,8 @@ bool NodeDB::DeleteState(uint64_t rowid, uint64_t& rowPrev)
 	rs.Step();
 	TestChanged1Row();
 
+	DelStateBlockAll(rowid);
+
 	return true;
 }
 
@@ -1150,12 +1196,18 @@ TxoID NodeDB::FindStateByTxoID(StateID& sid, TxoID id0)
 
 void NodeDB::SetStateBlock(uint64_t rowid, const Blob& bodyP, const Blob& bodyE)
 {
-	Recordset rs(*this, Query::StateSetBlock, "UPDATE " TblStates " SET " TblStates_BodyP "=?," TblStates_BodyE "=? WHERE rowid=?");
+	if (!bodyP.n && !bodyE.n)
+	{
+		DelStateBlockAll(rowid);
+		return;
+	}
+
+	Recordset rs(*this, Query::StateSetBlock, "INSERT OR REPLACE INTO " TblBlocks "(" TblBlocks_Row "," TblBlocks_BodyP "," TblBlocks_BodyE ") VALUES(?,?,?)");
+	rs.put(0, rowid);
 	if (bodyP.n)
-		rs.put(0, bodyP);
+		rs.put(1, bodyP);
 	if (bodyE.n)
-		rs.put(1, bodyE);
-	rs.put(2, rowid);
+		rs.put(2, bodyE);
 
 	rs.Step();
 	TestChanged1Row();
@@ -1163,9 +1215,10 @@ void NodeDB::SetStateBlock(uint64_t rowid, const Blob& bodyP, const Blob& bodyE)
 
 void NodeDB::GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE)
 {
-	Recordset rs(*this, Query::StateGetBlock, "SELECT " TblStates_BodyP "," TblStates_BodyE " FROM " TblStates " WHERE rowid=?");
+	Recordset rs(*this, Query::StateGetBlock, "SELECT " TblBlocks_BodyP "," TblBlocks_BodyE " FROM " TblBlocks " WHERE " TblBlocks_Row "=?");
 	rs.put(0, rowid);
-	rs.StepStrict();
+	if (!rs.Step())
+		return; // no block
 
 	if (pP && !rs.IsNull(0))
 		rs.get(0, *pP);
@@ -1175,16 +1228,18 @@ void NodeDB::GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE)
 
 void NodeDB::DelStateBlockPP(uint64_t rowid)
 {
-	Recordset rs(*this, Query::StateDelBlock, "UPDATE " TblStates " SET " TblStates_BodyP "=NULL," TblStates_Peer "=NULL WHERE rowid=?");
+	Recordset rs(*this, Query::StateDelBlock, "UPDATE " TblBlocks " SET " TblBlocks_BodyP "=NULL WHERE " TblBlocks_Row "=?");
 	rs.put(0, rowid);
 	rs.Step();
-	TestChanged1Row();
+
+	set_Peer(rowid, NULL);
 }
 
 void NodeDB::DelStateBlockAll(uint64_t rowid)
 {
-	Blob bEmpty(NULL, 0);
-	SetStateBlock(rowid, bEmpty, bEmpty);
+	Recordset rs(*this, Query::StateDelBlockAll, "DELETE FROM " TblBlocks " WHERE " TblBlocks_Row "=?");
+	rs.put(0, rowid);
+	rs.Step();
 }
 
 void NodeDB::SetFlags(uint64_t rowid, uint32_t n)
@@ -113,6 +113,7 @@ public:
 			StateGetBlock,
 			StateSetBlock,
 			StateDelBlock,
+			StateDelBlockAll,
 			EventIns,
 			EventDel,
 			EventEnum,
@@ -173,6 +174,7 @@ public:
 	void CheckIntegrity();
 
 	virtual void OnModified() {}
+	virtual void OnBlocksMoved() {} // upgraded to the separate blocks table, the freed pages are reclaimed only by vacuum
 
 	class Recordset
 	{
@@ -480,6 +482,9 @@ private:
 	void Create();
 	void CreateTableDummy();
 	void CreateTableTxos();
+	void CreateIndexStatesHash();
+	void CreateTableBlocks();
+	void MoveBlocksFromStates();
 	void ExecQuick(const char*);
 	std::string ExecTextOut(const char*);
 	bool ExecStep(sqlite3_stmt*);
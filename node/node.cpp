@@ -600,6 +600,7 @@ void Node::Processor::DeleteOutdated()
 void Node::Processor::OnNewState()
 {
     m_Cwp.Reset();
+    m_CwpCropped.clear();
 
 	if (!IsTreasuryHandled())
         return;
@@ -627,6 +628,8 @@ void Node::Processor::OnNewState()
         if (!(Peer::Flags::Connected & peer.m_Flags))
             continue;
 
+		peer.BroadcastUtxoEvents(); // before the tip, so that the viewer won't poll them
+
 		if (msg.m_Description.m_Height >= Rules::HeightGenesis)
 		{
 			if (!NodeProcessor::IsRemoteTipNeeded(msg.m_Description, peer.m_Tip))
@@ -672,7 +675,26 @@ void Node::MaybeGenerateRecovery()
 	std::string sTmp = sPath;
 	sTmp += ".tmp";
 
-	bool bOk = GenerateRecoveryInfo(sTmp.c_str());
+	// the previous file (if still there) is extended with the new and modified segments
+	std::string sPrev;
+	if (h0 && (h0 <= h1))
+	{
+		NodeDB::StateID sid;
+		sid.m_Height = h0;
+		sid.m_Row = m_Processor.FindActiveAtStrict(h0);
+
+		Block::SystemState::ID idPrev;
+		m_Processor.get_DB().get_StateID(sid, idPrev);
+
+		std::ostringstream osPrev;
+		osPrev
+			<< m_Cfg.m_Recovery.m_sPathOutput
+			<< idPrev;
+
+		sPrev = osPrev.str();
+	}
+
+	bool bOk = GenerateRecoverySegments(sTmp.c_str(), sPrev.empty() ? nullptr : sPrev.c_str());
 	if (bOk)
 	{
 #ifdef WIN32
@@ -700,6 +722,12 @@ void Node::Processor::OnRolledBack()
 {
     LOG_INFO() << "Rolled back to: " << m_Cursor.m_ID;
 
+	// the subscribed viewers would get the events of the new branch
+	Height hNext = m_Cursor.m_ID.m_Height + 1;
+	for (PeerList::iterator it = get_ParentObj().m_lstPeers.begin(); get_ParentObj().m_lstPeers.end() != it; it++)
+		if ((MaxHeight != it->m_CursorUtxoEvents) && (it->m_CursorUtxoEvents > hNext))
+			it->m_CursorUtxoEvents = hNext;
+
 	IObserver* pObserver = get_ParentObj().m_Cfg.m_Observer;
 	if (pObserver)
 		pObserver->OnRolledBack(m_Cursor.m_ID);
@@ -958,6 +986,11 @@ void Node::Processor::OnDummy(const Key::ID& kid, Height)
 	db.InsertDummy(h, kid);
 }
 
+void Node::Processor::OnRescanProgress(TxoID nDone, TxoID nTotal)
+{
+	LOG_INFO() << "Rescanning owned Txos: " << nDone << "/" << nTotal;
+}
+
 void Node::Processor::OnFlushTimer()
 {
     m_bFlushPending = false;
@@ -989,6 +1022,7 @@ Node::Peer* Node::AllocPeer(const beam::io::Address& addr)
     pPeer->m_LoginFlags = 0;
 	pPeer->m_CursorBbs = std::numeric_limits<int64_t>::max();
 	pPeer->m_pCursorTx = nullptr;
+	pPeer->m_CursorUtxoEvents = MaxHeight;
 
     LOG_INFO() << "+Peer " << addr;
 
@@ -1331,6 +1365,8 @@ void Node::Peer::SetupLogin(proto::Login& msg)
 
 	if (m_This.m_Cfg.m_Bbs.IsEnabled())
 		msg.m_Flags |= proto::LoginFlags::Bbs; // indicate ability to receive and broadcast BBS messages
+
+	msg.m_Flags |= proto::LoginFlags::UtxoEventsPush;
 }
 
 Height Node::Peer::get_MinPeerFork()
@@ -1644,6 +1680,7 @@ void Node::Peer::OnMsg(proto::Pong&&)
 	// not chocking - continue broadcast
 	BroadcastTxs();
 	BroadcastBbs();
+	BroadcastUtxoEvents();
 
 	for (Bbs::Subscription::PeerSet::iterator it = m_Subscriptions.begin(); m_Subscriptions.end() != it; it++)
 		BroadcastBbs(it->get_ParentObj());
@@ -1810,18 +1847,30 @@ void Node::Peer::OnMsg(proto::HdrPack&& msg)
     if (msg.m_vElements.empty() || (msg.m_vElements.size() > proto::g_HdrPackMaxSize))
         ThrowUnexpected();
 
-    Block::SystemState::Full s;
-    Cast::Down<Block::SystemState::Sequence::Prefix>(s) = msg.m_Prefix;
-    Cast::Down<Block::SystemState::Sequence::Element>(s) = msg.m_vElements.back();
+    // decode the whole pack, elements go in descending order
+    std::vector<Block::SystemState::Full> vStates(msg.m_vElements.size());
+
+    Block::SystemState::Full& s0 = vStates.front();
+    Cast::Down<Block::SystemState::Sequence::Prefix>(s0) = msg.m_Prefix;
+    Cast::Down<Block::SystemState::Sequence::Element>(s0) = msg.m_vElements.back();
+
+    for (size_t i = 1; i < vStates.size(); i++)
+    {
+        Block::SystemState::Full& s = vStates[i];
+        s = vStates[i - 1];
+        s.NextPrefix();
+        Cast::Down<Block::SystemState::Sequence::Element>(s) = msg.m_vElements[vStates.size() - i - 1];
+        s.m_ChainWork += s.m_PoW.m_Difficulty;
+    }
+
+    std::vector<NodeProcessor::DataStatus::Enum> vStatus(vStates.size());
+    m_This.m_Processor.OnStatesSilent(&vStates.front(), vStates.size(), m_pInfo->m_ID.m_Key, &vStatus.front());
 
     uint32_t nAccepted = 0;
     bool bInvalid = false;
 
-	Block::SystemState::ID idLast;
-
-    for (size_t i = msg.m_vElements.size(); ; )
+    for (NodeProcessor::DataStatus::Enum eStatus : vStatus)
     {
-        NodeProcessor::DataStatus::Enum eStatus = m_This.m_Processor.OnStateSilent(s, m_pInfo->m_ID.m_Key, idLast);
         switch (eStatus)
         {
         case NodeProcessor::DataStatus::Invalid:
@@ -1834,15 +1883,11 @@ void Node::Peer::OnMsg(proto::HdrPack&& msg)
         default:
             break; // suppress warning
         }
-
-        if (! --i)
-            break;
-
-        s.NextPrefix();
-        Cast::Down<Block::SystemState::Sequence::Element>(s) = msg.m_vElements[i - 1];
-        s.m_ChainWork += s.m_PoW.m_Difficulty;
     }
 
+	Block::SystemState::ID idLast;
+    vStates.back().get_ID(idLast);
+
     // just to be pedantic
     if (idLast != t.m_Key.first)
         bInvalid = true;
@@ -2974,16 +3019,33 @@ bool Node::Processor::BuildCwp()
     return true;
 }
 
+const Block::ChainWorkProof& Node::Processor::get_CwpCropped(const Difficulty::Raw& lowerBound)
+{
+    assert(!m_Cwp.IsEmpty());
+
+    auto it = m_CwpCropped.find(lowerBound);
+    if (m_CwpCropped.end() != it)
+        return it->second;
+
+    // light clients mostly ask with a few bounds, keep the cache small anyway
+    const size_t nMaxCropped = 32;
+    if (m_CwpCropped.size() >= nMaxCropped)
+        m_CwpCropped.erase(m_CwpCropped.begin());
+
+    Block::ChainWorkProof& cwp = m_CwpCropped[lowerBound];
+    cwp.m_LowerBound = lowerBound;
+    BEAM_VERIFY(cwp.Crop(m_Cwp, true)); // built here, its states were verified already
+
+    return cwp;
+}
+
 void Node::Peer::OnMsg(proto::GetProofChainWork&& msg)
 {
     proto::ProofChainWork msgOut;
 
     Processor& p = m_This.m_Processor;
     if (!p.IsFastSync() && p.BuildCwp())
-    {
-        msgOut.m_Proof.m_LowerBound = msg.m_LowerBound;
-        BEAM_VERIFY(msgOut.m_Proof.Crop(p.m_Cwp));
-    }
+        msgOut.m_Proof = p.get_CwpCropped(msg.m_LowerBound);
 
     Send(msgOut);
 }
@@ -3256,49 +3318,91 @@ void Node::Peer::OnMsg(proto::MacroblockGet&& msg)
     Send(proto::Macroblock()); // deprecated
 }
 
-void Node::Peer::OnMsg(proto::GetUtxoEvents&& msg)
+Height Node::Peer::ReadUtxoEvents(std::vector<proto::UtxoEvent>& v, Height hMin)
 {
-    proto::UtxoEvents msgOut;
+	// returns the height from which the next portion should be read
+	Processor& p = m_This.m_Processor;
+	NodeDB& db = p.get_DB();
+	NodeDB::WalkerEvent wlk(db);
 
-    if (Flags::Viewer & m_Flags)
-    {
-		Processor& p = m_This.m_Processor;
-		NodeDB& db = p.get_DB();
-        NodeDB::WalkerEvent wlk(db);
+	Height hLast = 0;
+	for (db.EnumEvents(wlk, hMin); wlk.MoveNext(); hLast = wlk.m_Height)
+	{
+		typedef NodeProcessor::UtxoEvent UE;
 
-        Height hLast = 0;
-        for (db.EnumEvents(wlk, msg.m_HeightMin); wlk.MoveNext(); hLast = wlk.m_Height)
-        {
-            typedef NodeProcessor::UtxoEvent UE;
+		if ((v.size() >= proto::UtxoEvent::s_Max) && (wlk.m_Height != hLast))
+			return hLast + 1;
 
-            if ((msgOut.m_Events.size() >= proto::UtxoEvent::s_Max) && (wlk.m_Height != hLast))
-                break;
+		if (p.IsFastSync() && (wlk.m_Height > p.m_SyncData.m_h0))
+			return p.m_SyncData.m_h0 + 1;
 
-			if (p.IsFastSync() && (wlk.m_Height > p.m_SyncData.m_h0))
-				break;
+		if (wlk.m_Body.n < sizeof(UE::Value) || (wlk.m_Key.n != sizeof(ECC::Point)))
+			continue; // although shouldn't happen
+		const UE::Value& evt = *reinterpret_cast<const UE::Value*>(wlk.m_Body.p);
+
+		v.emplace_back();
+		proto::UtxoEvent& res = v.back();
 
-            if (wlk.m_Body.n < sizeof(UE::Value) || (wlk.m_Key.n != sizeof(ECC::Point)))
-                continue; // although shouldn't happen
-            const UE::Value& evt = *reinterpret_cast<const UE::Value*>(wlk.m_Body.p);
+		res.m_Height = wlk.m_Height;
+		res.m_Kidv = evt.m_Kidv;
+		evt.m_Maturity.Export(res.m_Maturity);
 
-            msgOut.m_Events.emplace_back();
-            proto::UtxoEvent& res = msgOut.m_Events.back();
+		res.m_Commitment = *reinterpret_cast<const ECC::Point*>(wlk.m_Key.p);
+		res.m_AssetID = evt.m_AssetID;
+		res.m_Added = evt.m_Added;
+	}
 
-            res.m_Height = wlk.m_Height;
-            res.m_Kidv = evt.m_Kidv;
-            evt.m_Maturity.Export(res.m_Maturity);
+	return std::max(hMin, p.m_Cursor.m_ID.m_Height + 1);
+}
 
-            res.m_Commitment = *reinterpret_cast<const ECC::Point*>(wlk.m_Key.p);
-            res.m_AssetID = evt.m_AssetID;
-            res.m_Added = evt.m_Added;
-        }
-    }
+void Node::Peer::BroadcastUtxoEvents()
+{
+	Processor& p = m_This.m_Processor;
+	if (p.IsFastSync())
+		return;
+
+	// a subscription from a low height may cover the whole history. Stop while the peer is chocking, resume once it's drained
+	Height hTip = p.m_Cursor.m_ID.m_Height;
+	while ((m_CursorUtxoEvents <= hTip) && !IsChocking())
+	{
+		proto::UtxoEventsNew msgOut;
+		msgOut.m_HeightMin = m_CursorUtxoEvents;
+		msgOut.m_HeightNext = ReadUtxoEvents(msgOut.m_Events, m_CursorUtxoEvents);
+
+		Send(msgOut);
+		m_CursorUtxoEvents = msgOut.m_HeightNext;
+	}
+}
+
+void Node::Peer::OnMsg(proto::GetUtxoEvents&& msg)
+{
+    proto::UtxoEvents msgOut;
+
+    if (Flags::Viewer & m_Flags)
+		ReadUtxoEvents(msgOut.m_Events, msg.m_HeightMin);
     else
         LOG_WARNING() << "Peer " << m_RemoteAddr << " Unauthorized Utxo events request.";
 
     Send(msgOut);
 }
 
+void Node::Peer::OnMsg(proto::UtxoEventsSubscribe&& msg)
+{
+	if (!(Flags::Viewer & m_Flags))
+	{
+		LOG_WARNING() << "Peer " << m_RemoteAddr << " Unauthorized Utxo events subscription.";
+		return;
+	}
+
+	if (msg.m_On)
+	{
+		m_CursorUtxoEvents = msg.m_HeightMin;
+		BroadcastUtxoEvents();
+	}
+	else
+		m_CursorUtxoEvents = MaxHeight;
+}
+
 void Node::Peer::OnMsg(proto::BlockFinalization&& msg)
 {
     if (!(Flags::Owner & m_Flags) ||
@@ -4133,4 +4237,111 @@ bool Node::GenerateRecoveryInfo(const char* szPath)
 	return true;
 }
 
+bool Node::GenerateRecoverySegments(const char* szPath, const char* szPrev)
+{
+	if (!m_Processor.BuildCwp())
+		return false; // no info yet
+
+	struct MyWalker
+		:public NodeProcessor::ITxoWalker
+	{
+		RecoveryInfo::SegmentedWriter m_Writer;
+
+		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate) override
+		{
+			if (MaxHeight != wlk.m_SpendHeight)
+				return true;
+
+			Deserializer der;
+			der.reset(wlk.m_Value.p, wlk.m_Value.n);
+
+			RecoveryInfo::Entry val;
+			der & val.m_Output;
+
+			val.m_CreateHeight = hCreate;
+			val.m_Output.m_RecoveryOnly = true;
+
+			m_Writer.Write(val);
+			return true;
+		}
+	};
+
+	MyWalker wlk;
+	NodeDB& db = m_Processor.get_DB();
+	const Height hTip = m_Processor.m_Cursor.m_ID.m_Height;
+
+	try
+	{
+		// The segments of the previous file are reused if they're below its tip, which is still in the current branch,
+		// and none of their UTXOs were spent since. If the dead data outweighs the live one (and is above 1MB) - the file is rewritten.
+		Height hReuse = 0;
+		std::set<Height> setDirty;
+
+		if (szPrev && wlk.m_Writer.Append(szPrev, szPath))
+		{
+			const Block::SystemState::Full& sPrev = wlk.m_Writer.m_Tip;
+			const RecoveryInfo::Index& idx = wlk.m_Writer.m_Index;
+
+			if ((sPrev.m_Height <= hTip) && (idx.m_SizeDead <= std::max<uint64_t>(idx.get_SizeLive(), 1U << 20)))
+			{
+				NodeDB::StateID sid;
+				sid.m_Height = sPrev.m_Height;
+				sid.m_Row = m_Processor.FindActiveAtStrict(sPrev.m_Height);
+
+				Block::SystemState::ID id0, id1;
+				db.get_StateID(sid, id0);
+				sPrev.get_ID(id1);
+
+				if (id0 == id1)
+					hReuse = sPrev.m_Height;
+			}
+
+			if (hReuse)
+			{
+				NodeDB::WalkerTxo wlkSpent(db);
+				for (db.EnumTxosBySpent(wlkSpent, HeightRange(hReuse + 1, hTip)); wlkSpent.MoveNext(); )
+				{
+					NodeDB::StateID sid;
+					db.FindStateByTxoID(sid, wlkSpent.m_ID);
+					setDirty.insert(sid.m_Height - sid.m_Height % RecoveryInfo::s_SegmentHeights);
+				}
+			}
+			else
+				wlk.m_Writer.Create(szPath);
+		}
+		else
+			wlk.m_Writer.Create(szPath);
+
+		uint32_t nReused = 0, nWritten = 0;
+
+		for (Height h = 0; h <= hTip; h += RecoveryInfo::s_SegmentHeights)
+		{
+			HeightRange hr(h, std::min(h + RecoveryInfo::s_SegmentHeights - 1, hTip));
+
+			const RecoveryInfo::Segment* pSeg = wlk.m_Writer.m_Index.Find(h);
+			if (pSeg && (pSeg->m_Heights.m_Max == hr.m_Max) && (hr.m_Max <= hReuse) && !setDirty.count(h))
+			{
+				nReused++;
+				continue;
+			}
+
+			wlk.m_Writer.SegmentStart(hr);
+			m_Processor.EnumTxos(wlk, hr);
+			wlk.m_Writer.SegmentEnd();
+			nWritten++;
+		}
+
+		wlk.m_Writer.Close(m_Processor.m_Cwp);
+
+		LOG_INFO() << "Recovery segments reused: " << nReused << ", written: " << nWritten;
+	}
+	catch (const std::exception& ex)
+	{
+		LOG_ERROR() << ex.what();
+		return false;
+	}
+
+	return true;
+}
+
 } // namespace beam
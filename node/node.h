@@ -165,6 +165,7 @@ struct Node
 	void Initialize(IExternalPOW* externalPOW=nullptr);
 
 	NodeProcessor& get_Processor() { return m_Processor; } // for tests only!
+	const TxPool::Fluff& get_TxPool() const { return m_TxPool; }
 
 	struct SyncStatus
 	{
@@ -185,6 +186,7 @@ struct Node
 	bool m_PostStartSynced = false;
 
 	bool GenerateRecoveryInfo(const char*);
+	bool GenerateRecoverySegments(const char* szPath, const char* szPrev = nullptr); // reuses the unmodified segments of the previous file
 
 private:
 
@@ -200,6 +202,7 @@ private:
 		bool EnumViewerKeys(IKeyWalker&) override;
 		void OnUtxoEvent(const UtxoEvent::Value&) override;
 		void OnDummy(const Key::ID&, Height) override;
+		void OnRescanProgress(TxoID nDone, TxoID nTotal) override;
 		void Stop();
 
 		struct TaskProcessor
@@ -242,6 +245,10 @@ private:
 		Block::ChainWorkProof m_Cwp; // cached
 		bool BuildCwp();
 
+		// m_Cwp cropped for the lower bounds requested so far, all for the current tip
+		std::map<Difficulty::Raw, Block::ChainWorkProof> m_CwpCropped;
+		const Block::ChainWorkProof& get_CwpCropped(const Difficulty::Raw& lowerBound);
+
 		void GenerateProofStateStrict(Merkle::HardProof&, Height);
 
 		bool m_bFlushPending = false;
@@ -469,6 +476,7 @@ private:
 
 		uint64_t m_CursorBbs;
 		TxPool::Fluff::Element* m_pCursorTx;
+		Height m_CursorUtxoEvents; // MaxHeight if not subscribed
 
 		TaskList m_lstTasks;
 		std::set<Task::Key> m_setRejected; // data that shouldn't be requested from this peer. Reset after reconnection or on receiving NewTip
@@ -498,6 +506,8 @@ private:
 		void OnChocking();
 		void SetTxCursor(TxPool::Fluff::Element*);
 		bool GetBlock(proto::BodyBuffers&, const NodeDB::StateID&, const proto::GetBodyPack&);
+		Height ReadUtxoEvents(std::vector<proto::UtxoEvent>&, Height hMin);
+		void BroadcastUtxoEvents();
 
 		bool IsChocking(size_t nExtra = 0);
 		bool ShouldAssignTasks();
@@ -553,6 +563,7 @@ private:
 		virtual void OnMsg(proto::BbsResetSync&&) override;
 		virtual void OnMsg(proto::MacroblockGet&&) override;
 		virtual void OnMsg(proto::GetUtxoEvents&&) override;
+		virtual void OnMsg(proto::UtxoEventsSubscribe&&) override;
 		virtual void OnMsg(proto::BlockFinalization&&) override;
 	};
 
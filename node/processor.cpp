@@ -19,6 +19,7 @@
 #include "../utility/logger.h"
 #include "../utility/logger_checkpoints.h"
 #include <condition_variable>
+#include <atomic>
 
 namespace beam {
 
@@ -36,6 +37,11 @@ NodeProcessor::Horizon::Horizon()
 {
 }
 
+void NodeProcessor::DB::OnBlocksMoved()
+{
+	LOG_WARNING() << "Block bodies moved to the separate table. The DB file won't shrink until vacuumed, run once with --check_db=1 to reclaim the space";
+}
+
 void NodeProcessor::Initialize(const char* szPath)
 {
 	StartParams sp; // defaults
@@ -1656,50 +1662,149 @@ void NodeProcessor::RescanOwnedTxos()
 
 	m_DB.DeleteEventsFrom(Rules::HeightGenesis - 1);
 
+	// Txos are collected in batches. The recovery attempts (deserialization and rangeproof rewinds) of a batch
+	// are shared between all the verification threads, then the events are inserted in the original order.
 	struct TxoRecover
-		:public ITxoRecover
+		:public ITxoWalker
+		,public Task
 	{
+		struct Element
+		{
+			ByteBuffer m_Value;
+			Height m_hCreate;
+			Height m_hSpend;
+
+			// result
+			bool m_Recovered;
+			Key::IDV m_Kidv;
+			ECC::Point m_Commitment;
+			Height m_Maturity;
+			AssetID m_AssetID;
+		};
+
+		NodeProcessor& m_This;
+
+		std::vector<Element> m_vBatch;
+		size_t m_nBatch = 0;
+		std::atomic<size_t> m_iNext;
+
 		uint32_t m_Total = 0;
 		uint32_t m_Unspent = 0;
+		TxoID m_Done = 0;
+		TxoID m_Percent = 0;
 
-		TxoRecover(NodeProcessor& x) :ITxoRecover(x) {}
+		TxoRecover(NodeProcessor& x)
+			:m_This(x)
+			,m_vBatch(0x1000)
+		{
+		}
 
-		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp, const Key::IDV& kidv) override
+		virtual bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate) override
 		{
-			if (IsDummy(kidv))
+			if (m_vBatch.size() == m_nBatch)
+				FlushBatch();
+
+			Element& x = m_vBatch[m_nBatch++];
+
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(wlk.m_Value.p);
+			x.m_Value.assign(p, p + wlk.m_Value.n);
+			x.m_hCreate = hCreate;
+			x.m_hSpend = wlk.m_SpendHeight;
+
+			return true;
+		}
+
+		virtual void Exec() override
+		{
+			while (true)
+			{
+				size_t i = m_iNext++;
+				if (i >= m_nBatch)
+					break;
+
+				Element& x = m_vBatch[i];
+
+				Deserializer der;
+				der.reset(x.m_Value);
+
+				Output outp;
+				der & outp;
+
+				x.m_Recovered = m_This.Recover(x.m_Kidv, outp, x.m_hCreate);
+				if (x.m_Recovered)
+				{
+					x.m_Commitment = outp.m_Commitment;
+					x.m_Maturity = outp.get_MinMaturity(x.m_hCreate);
+					x.m_AssetID = outp.m_AssetID;
+				}
+			}
+		}
+
+		void FlushBatch()
+		{
+			if (!m_nBatch)
+				return;
+
+			m_iNext = 0;
+			m_This.get_TaskProcessor().ExecAll(*this);
+
+			for (size_t i = 0; i < m_nBatch; i++)
+			{
+				const Element& x = m_vBatch[i];
+				if (x.m_Recovered)
+					OnRecovered(x);
+			}
+
+			m_Done += m_nBatch;
+			m_nBatch = 0;
+
+			TxoID nTotal = m_This.m_Extra.m_Txos;
+			if (nTotal)
 			{
-				m_This.OnDummy(kidv, hCreate);
-				return true;
+				TxoID nPercent = std::min<TxoID>(m_Done, nTotal) * 100 / nTotal;
+				if (nPercent != m_Percent)
+				{
+					m_Percent = nPercent;
+					m_This.OnRescanProgress(m_Done, nTotal);
+				}
+			}
+		}
+
+		void OnRecovered(const Element& x)
+		{
+			if (IsDummy(x.m_Kidv))
+			{
+				m_This.OnDummy(x.m_Kidv, x.m_hCreate);
+				return;
 			}
 
 			UtxoEvent::Value evt;
-			evt.m_Kidv = kidv;
-			evt.m_Maturity = outp.get_MinMaturity(hCreate);
+			evt.m_Kidv = x.m_Kidv;
+			evt.m_Maturity = x.m_Maturity;
 			evt.m_Added = 1;
-			evt.m_AssetID = outp.m_AssetID;
+			evt.m_AssetID = x.m_AssetID;
 
-			const UtxoEvent::Key& key = outp.m_Commitment;
+			const UtxoEvent::Key& key = x.m_Commitment;
 
-			m_This.get_DB().InsertEvent(hCreate, Blob(&evt, sizeof(evt)), Blob(&key, sizeof(key)));
+			m_This.get_DB().InsertEvent(x.m_hCreate, Blob(&evt, sizeof(evt)), Blob(&key, sizeof(key)));
 			m_This.OnUtxoEvent(evt);
 
 			m_Total++;
 
-			if (MaxHeight == wlk.m_SpendHeight)
+			if (MaxHeight == x.m_hSpend)
 				m_Unspent++;
 			else
 			{
 				evt.m_Added = 0;
-				m_This.get_DB().InsertEvent(wlk.m_SpendHeight, Blob(&evt, sizeof(evt)), Blob(&key, sizeof(key)));
+				m_This.get_DB().InsertEvent(x.m_hSpend, Blob(&evt, sizeof(evt)), Blob(&key, sizeof(key)));
 				m_This.OnUtxoEvent(evt);
 			}
-
-			return true;
 		}
 	};
 
 	TxoRecover wlk(*this);
 	EnumTxos(wlk);
+	wlk.FlushBatch();
 
 	LOG_INFO() << "Recovered " << wlk.m_Unspent << "/" << wlk.m_Total << " unspent/total Txos";
 }
@@ -2013,11 +2118,11 @@ void NodeProcessor::RollbackTo(Height h)
 	m_Extra.m_Txos = id0;
 }
 
-NodeProcessor::DataStatus::Enum NodeProcessor::OnStateInternal(const Block::SystemState::Full& s, Block::SystemState::ID& id)
+NodeProcessor::DataStatus::Enum NodeProcessor::OnStateInternal(const Block::SystemState::Full& s, Block::SystemState::ID& id, bool bTestPoW)
 {
 	s.get_ID(id);
 
-	if (!s.IsValid())
+	if (!s.IsSane() || (bTestPoW && !s.IsValidPoW()))
 	{
 		LOG_WARNING() << id << " header invalid!";
 		return DataStatus::Invalid;
@@ -2068,6 +2173,67 @@ NodeProcessor::DataStatus::Enum NodeProcessor::OnStateSilent(const Block::System
 	return ret;
 }
 
+void NodeProcessor::OnStatesSilent(const Block::SystemState::Full* pS, size_t nCount, const PeerID& peer, DataStatus::Enum* pStatus)
+{
+	struct MyTask
+		:public Task
+	{
+		const Block::SystemState::Full* m_pS;
+		std::vector<size_t> m_vIdx; // states to verify
+		std::vector<uint8_t> m_vValid;
+		std::atomic<size_t> m_iNext;
+
+		virtual void Exec() override
+		{
+			while (true)
+			{
+				size_t i = m_iNext++;
+				if (i >= m_vIdx.size())
+					break;
+
+				m_vValid[i] = m_pS[m_vIdx[i]].IsValidPoW();
+			}
+		}
+	};
+
+	MyTask t;
+	t.m_pS = pS;
+	t.m_iNext = 0;
+
+	// everything but PoW, which is the only expensive part. Already known states are not verified again
+	for (size_t i = 0; i < nCount; i++)
+	{
+		Block::SystemState::ID id;
+		pStatus[i] = OnStateInternal(pS[i], id, false);
+		if (DataStatus::Accepted == pStatus[i])
+			t.m_vIdx.push_back(i);
+	}
+
+	if (t.m_vIdx.empty())
+		return;
+
+	t.m_vValid.resize(t.m_vIdx.size());
+	get_TaskProcessor().ExecAll(t);
+
+	// the states go to the DB transaction that's always open, committed along with the rest
+	for (size_t i = 0; i < t.m_vIdx.size(); i++)
+	{
+		const Block::SystemState::Full& s = pS[t.m_vIdx[i]];
+		if (!t.m_vValid[i])
+		{
+			Block::SystemState::ID id;
+			s.get_ID(id);
+			LOG_WARNING() << id << " header invalid!";
+
+			pStatus[t.m_vIdx[i]] = DataStatus::Invalid;
+			continue;
+		}
+
+		uint64_t rowid = m_DB.InsertState(s);
+		m_DB.set_Peer(rowid, &peer);
+	}
+}
+
 NodeProcessor::DataStatus::Enum NodeProcessor::OnBlock(const Block::SystemState::ID& id, const Blob& bbP, const Blob& bbE, const PeerID& peer)
 {
 	NodeDB::StateID sid;
@@ -28,6 +28,7 @@ class NodeProcessor
 	{
 		// NodeDB
 		virtual void OnModified() override { get_ParentObj().OnModified(); }
+		virtual void OnBlocksMoved() override;
 		IMPLEMENT_GET_PARENT_OBJ(NodeProcessor, m_DB)
 	} m_DB;
 
@@ -191,6 +192,8 @@ public:
 
 	DataStatus::Enum OnState(const Block::SystemState::Full&, const PeerID&);
 	DataStatus::Enum OnStateSilent(const Block::SystemState::Full&, const PeerID&, Block::SystemState::ID&);
+	// Header batch (HdrPack). Checked in one pass, PoW verified in parallel on the task processor, then inserted.
+	void OnStatesSilent(const Block::SystemState::Full*, size_t nCount, const PeerID&, DataStatus::Enum* pStatus);
 	DataStatus::Enum OnBlock(const Block::SystemState::ID&, const Blob& bbP, const Blob& bbE, const PeerID&);
 	DataStatus::Enum OnBlock(const NodeDB::StateID&, const Blob& bbP, const Blob& bbE, const PeerID&);
 	DataStatus::Enum OnTreasury(const Blob&);
@@ -329,13 +332,14 @@ public:
 
 	virtual void OnUtxoEvent(const UtxoEvent::Value&) {}
 	virtual void OnDummy(const Key::ID&, Height) {}
+	virtual void OnRescanProgress(TxoID nDone, TxoID nTotal) {} // called on each whole percent
 
 	static bool IsDummy(const Key::IDV&);
 
 private:
 	size_t GenerateNewBlockInternal(BlockContext&);
 	void GenerateNewHdr(BlockContext&);
-	DataStatus::Enum OnStateInternal(const Block::SystemState::Full&, Block::SystemState::ID&);
+	DataStatus::Enum OnStateInternal(const Block::SystemState::Full&, Block::SystemState::ID&, bool bTestPoW = true);
 };
 
 struct LogSid
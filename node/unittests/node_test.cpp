@@ -23,6 +23,7 @@
 #include "../../core/block_rw.h"
 #include "../../utility/test_helpers.h"
 #include "../../utility/serialize.h"
+#include "../../utility/io/buffer.h"
 #include "../../core/unittest/mini_blockchain.h"
 
 #ifndef LOG_VERBOSE_ENABLED
@@ -275,6 +276,15 @@ namespace beam
 			}
 		}
 
+		for (uint32_t h = 0; h < hMax; h++)
+		{
+			Merkle::Hash hv;
+			vStates[h].get_Hash(hv);
+			verify_test(db.FindBlock(hv) == vStates[h].m_Height);
+		}
+
+		verify_test(db.FindBlock(hvZero) == Rules::HeightGenesis - 1);
+
 		Blob bBodyP("body", 4), bBodyE("abc", 3);
 		Merkle::Hash peer, peer2;
 		memset(peer.m_pData, 0x66, peer.nBytes);
@@ -559,6 +569,124 @@ namespace beam
 		}
 	}
 
+	void ExecSql(const char* szPath, const char* szSql)
+	{
+		sqlite3* pDb = nullptr;
+		verify_test(SQLITE_OK == sqlite3_open_v2(szPath, &pDb, SQLITE_OPEN_READWRITE, NULL));
+		verify_test(SQLITE_OK == sqlite3_exec(pDb, szSql, NULL, NULL, NULL));
+		sqlite3_close(pDb);
+	}
+
+	void TestNodeDBUpgrade(uint64_t nVer)
+	{
+		// create a DB, then bring it back to the layout of an older version, with the bodies inside the states table
+		DeleteFile(g_sz);
+
+		struct MyDB
+			:public NodeDB
+		{
+			uint32_t m_nMoved = 0;
+			virtual void OnBlocksMoved() override { m_nMoved++; }
+		};
+
+		const uint32_t nStates = 4;
+		Block::SystemState::Full pStates[nStates];
+		uint64_t pRows[nStates];
+
+		{
+			MyDB db;
+			db.Open(g_sz);
+			NodeDB::Transaction tr(db);
+
+			for (uint32_t i = 0; i < nStates; i++)
+			{
+				Block::SystemState::Full& s = pStates[i];
+				ZeroObject(s);
+				s.m_Height = Rules::HeightGenesis + i;
+				s.m_ChainWork = i;
+				if (i)
+					pStates[i - 1].get_Hash(s.m_Prev);
+
+				pRows[i] = db.InsertState(s);
+
+				// the last one has no body, the one before has only the eternal part
+				if (i + 1 < nStates)
+				{
+					uint8_t pP[] = { uint8_t(i), 1 };
+					uint8_t pE[] = { uint8_t(i), 2 };
+					db.SetStateBlock(pRows[i], (i + 2 < nStates) ? Blob(pP, sizeof(pP)) : Blob(nullptr, 0), Blob(pE, sizeof(pE)));
+				}
+			}
+
+			tr.Commit();
+			verify_test(!db.m_nMoved);
+		}
+
+		std::string sSql =
+			"ALTER TABLE States ADD COLUMN Perishable BLOB;"
+			"ALTER TABLE States ADD COLUMN Ethernal BLOB;"
+			"UPDATE States SET Perishable=(SELECT Perishable FROM Blocks WHERE Row=States.rowid),Ethernal=(SELECT Ethernal FROM Blocks WHERE Row=States.rowid);"
+			"DROP TABLE Blocks;";
+
+		if (nVer < 18)
+			sSql += "DROP INDEX IdxStatesHash;";
+
+		sSql += "UPDATE Params SET ParamInt=" + std::to_string(nVer) + " WHERE ID=" + std::to_string(NodeDB::ParamID::DbVer) + ";";
+
+		ExecSql(g_sz, sSql.c_str());
+
+		for (uint32_t iPass = 0; iPass < 2; iPass++)
+		{
+			MyDB db;
+			db.Open(g_sz);
+			verify_test(db.m_nMoved == (iPass ? 0U : 1U)); // only once
+
+			verify_test(db.ParamIntGetDef(NodeDB::ParamID::DbVer) > nVer);
+
+			for (uint32_t i = 0; i < nStates; i++)
+			{
+				ByteBuffer bufP, bufE;
+				db.GetStateBlock(pRows[i], &bufP, &bufE);
+
+				if (i + 1 < nStates)
+				{
+					verify_test((bufE.size() == 2) && (bufE[0] == i) && (bufE[1] == 2));
+					if (i + 2 < nStates)
+						verify_test((bufP.size() == 2) && (bufP[0] == i) && (bufP[1] == 1));
+					else
+						verify_test(bufP.empty());
+				}
+				else
+					verify_test(bufP.empty() && bufE.empty()); // no row in the blocks table
+
+				Merkle::Hash hv;
+				pStates[i].get_Hash(hv);
+				verify_test(db.FindBlock(hv) == pStates[i].m_Height);
+			}
+
+			if (!iPass)
+			{
+				// pruning and deletion work on the moved rows
+				NodeDB::Transaction tr(db);
+
+				db.DelStateBlockPP(pRows[0]);
+				db.DelStateBlockAll(pRows[1]);
+
+				ByteBuffer bufP, bufE;
+				db.GetStateBlock(pRows[0], &bufP, &bufE);
+				verify_test(bufP.empty() && (bufE.size() == 2));
+
+				bufE.clear();
+				db.GetStateBlock(pRows[1], &bufP, &bufE);
+				verify_test(bufP.empty() && bufE.empty());
+
+				tr.Rollback();
+			}
+		}
+
+		DeleteFile(g_sz);
+	}
+
 	struct MiniWallet
 	{
 		Key::IKdf::Ptr m_pKdf;
@@ -899,6 +1027,30 @@ namespace beam
 
 			for (size_t i = 0; i < blockChain.size(); i += 2)
 				np.OnState(blockChain[i]->m_Hdr, peer);
+
+			// header batch: known states are rejected, an insane one is invalid, the rest inserted
+			std::vector<Block::SystemState::Full> vS;
+			for (size_t i = 0; i < 8; i++)
+				vS.push_back(blockChain[i]->m_Hdr);
+			vS[3].m_Height = 0;
+
+			std::vector<NodeProcessor::DataStatus::Enum> vStatus(vS.size());
+			np.OnStatesSilent(&vS.front(), vS.size(), peer, &vStatus.front());
+
+			for (size_t i = 0; i < vS.size(); i++)
+			{
+				NodeProcessor::DataStatus::Enum eExpected =
+					(i == 3) ? NodeProcessor::DataStatus::Invalid :
+					(i & 1) ? NodeProcessor::DataStatus::Accepted :
+					NodeProcessor::DataStatus::Rejected;
+				verify_test(vStatus[i] == eExpected);
+			}
+
+			Block::SystemState::ID id;
+			blockChain[5]->m_Hdr.get_ID(id);
+			verify_test(np.get_DB().StateFindSafe(id));
+			blockChain[3]->m_Hdr.get_ID(id);
+			verify_test(!np.get_DB().StateFindSafe(id));
 		}
 
 		{
@@ -1449,6 +1601,54 @@ namespace beam
 		rp.Finalyze(); // final verification
 
 		DeleteFile(g_sz3);
+
+		// segmented format: the 2nd file is appended to the copy of the 1st one, all its segments are reused
+		std::string pSeg[2];
+		pSeg[0] = std::string(g_sz3) + "seg0";
+		pSeg[1] = std::string(g_sz3) + "seg1";
+
+		verify_test(node.GenerateRecoverySegments(pSeg[0].c_str()));
+		verify_test(node.GenerateRecoverySegments(pSeg[1].c_str(), pSeg[0].c_str()));
+
+		RecoveryInfo::SegmentedReader pRs[2];
+		for (uint32_t iFile = 0; iFile < _countof(pSeg); iFile++)
+		{
+			const char* sz = pSeg[iFile].c_str();
+			verify_test(RecoveryInfo::SegmentedReader::IsSegmented(sz));
+
+			RecoveryInfo::SegmentedReader& rs = pRs[iFile];
+			rs.Open(sz);
+			verify_test(rs.m_Tip.m_Height == node.get_Processor().m_Cursor.m_ID.m_Height);
+
+			io::SharedBuffer buf = io::map_file_read_only(sz);
+			Blob file(buf.data, static_cast<uint32_t>(buf.size));
+
+			std::vector<UtxoTree::Key> vKeys;
+			for (size_t iSeg = 0; iSeg < rs.m_Index.m_vSegments.size(); iSeg++)
+			{
+				RecoveryInfo::SegmentParser sp;
+				sp.Open(rs.m_Index.m_vSegments[iSeg], file);
+
+				while (true)
+				{
+					RecoveryInfo::Entry x;
+					if (!sp.Read(x))
+						break;
+
+					RecoveryInfo::get_Key(vKeys.emplace_back(), x);
+				}
+			}
+
+			RecoveryInfo::VerifyUtxos(vKeys, rs.m_Index.m_Cwp.m_hvRootLive);
+		}
+
+		verify_test(pRs[0].m_Index.m_vSegments.size() == pRs[1].m_Index.m_vSegments.size());
+		for (size_t iSeg = 0; iSeg < pRs[0].m_Index.m_vSegments.size(); iSeg++)
+			verify_test(pRs[0].m_Index.m_vSegments[iSeg].m_Offset == pRs[1].m_Index.m_vSegments[iSeg].m_Offset);
+		verify_test(pRs[1].m_Index.m_SizeDead > pRs[0].m_Index.m_SizeDead); // the old index
+
+		for (uint32_t iFile = 0; iFile < _countof(pSeg); iFile++)
+			DeleteFile(pSeg[iFile].c_str());
 	}
 
 
@@ -2006,6 +2206,259 @@ namespace beam
 	}
 
 
+	void TestNodeUtxoEventsPush()
+	{
+		// Node <-> viewer client, subscribed to the UTXO events, and a client without the viewer rights.
+		// The node is fed blocks directly. In the end it switches to a longer alternative branch, built by another node.
+
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		Node node, nodeAlt;
+		node.m_Cfg.m_sPathLocal = g_sz;
+		node.m_Cfg.m_Listen.port(g_Port);
+		node.m_Cfg.m_Listen.ip(INADDR_ANY);
+		node.m_Cfg.m_Treasury = g_Treasury;
+
+		nodeAlt.m_Cfg.m_sPathLocal = g_sz2;
+		nodeAlt.m_Cfg.m_Treasury = g_Treasury;
+
+		ECC::SetRandom(node);
+		ECC::SetRandom(nodeAlt);
+
+		node.Initialize();
+		nodeAlt.Initialize();
+
+		struct MinedBlock
+		{
+			Block::SystemState::Full m_Hdr;
+			ByteBuffer m_BodyP;
+			ByteBuffer m_BodyE;
+
+			void Feed(Node& n) const
+			{
+				n.get_Processor().OnState(m_Hdr, PeerID());
+
+				Block::SystemState::ID id;
+				m_Hdr.get_ID(id);
+
+				n.get_Processor().OnBlock(id, m_BodyP, m_BodyE, PeerID());
+				n.get_Processor().TryGoUp();
+			}
+
+			void Mine(Node& n)
+			{
+				TxPool::Fluff txPool; // empty, no transactions
+				NodeProcessor::BlockContext bc(txPool, 0, *n.m_Keys.m_pMiner, *n.m_Keys.m_pMiner);
+				verify_test(n.get_Processor().GenerateNewBlock(bc));
+
+				m_Hdr = bc.m_Hdr;
+				m_BodyP.swap(bc.m_BodyP);
+				m_BodyE.swap(bc.m_BodyE);
+
+				Feed(n);
+			}
+		};
+
+		const Height hFork = 3;
+		const Height hMain = 5;
+		const Height hAlt = 9;
+
+		for (Height h = 1; h <= hMain; h++)
+		{
+			MinedBlock mb;
+			mb.Mine(node);
+			if (h <= hFork)
+				mb.Feed(nodeAlt);
+		}
+
+		std::vector<MinedBlock> vAlt(hAlt - hFork);
+		for (size_t i = 0; i < vAlt.size(); i++)
+			vAlt[i].Mine(nodeAlt);
+
+		verify_test(node.get_Processor().m_Cursor.m_ID.m_Height == hMain);
+		verify_test(nodeAlt.get_Processor().m_Cursor.m_ID.m_Height == hAlt);
+
+		struct MyClient
+			:public proto::NodeConnection
+		{
+			Node& m_Node;
+			const std::vector<MinedBlock>& m_vAlt;
+			Key::IKdf::Ptr m_pKdf;
+
+			Height m_hEvtNext = 0; // expected HeightMin of the next push
+			uint32_t m_nPushes = 0;
+			bool m_bReorg = false;
+			bool m_bDone = false;
+
+			MyClient(Node& n, const std::vector<MinedBlock>& vAlt)
+				:m_Node(n)
+				,m_vAlt(vAlt)
+				,m_pKdf(n.m_Keys.m_pMiner)
+			{
+			}
+
+			virtual void OnConnectedSecure() override
+			{
+				SendLogin();
+			}
+
+			virtual void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+				io::Reactor::get_Current().stop();
+			}
+
+			virtual void OnMsg(proto::Authentication&& msg) override
+			{
+				proto::NodeConnection::OnMsg(std::move(msg));
+
+				switch (msg.m_IDType)
+				{
+				case proto::IDType::Node:
+					ProveKdfObscured(*m_pKdf, proto::IDType::Owner);
+					break;
+
+				case proto::IDType::Viewer:
+					{
+						// the node has granted us the viewer rights, subscribe from the beginning
+						proto::UtxoEventsSubscribe msgOut;
+						msgOut.m_HeightMin = 1;
+						msgOut.m_On = true;
+						Send(msgOut);
+
+						m_hEvtNext = 1;
+					}
+					break;
+
+				default: // suppress warning
+					break;
+				}
+			}
+
+			virtual void OnMsg(proto::UtxoEventsNew&& msg) override
+			{
+				verify_test(msg.m_HeightMin == m_hEvtNext);
+				verify_test(msg.m_HeightNext <= m_Node.get_Processor().m_Cursor.m_ID.m_Height + 1); // the node may be ahead already
+
+				for (size_t i = 0; i < msg.m_Events.size(); i++)
+				{
+					const proto::UtxoEvent& evt = msg.m_Events[i];
+					verify_test((evt.m_Height >= msg.m_HeightMin) && (evt.m_Height < msg.m_HeightNext));
+
+					ECC::Scalar::Native sk;
+					ECC::Point comm;
+					SwitchCommitment(&evt.m_AssetID).Create(sk, comm, *m_pKdf, evt.m_Kidv);
+					verify_test(comm == evt.m_Commitment);
+				}
+
+				m_hEvtNext = msg.m_HeightNext;
+
+				switch (++m_nPushes)
+				{
+				case 1:
+					{
+						// initial history received. New tip
+						MinedBlock mb;
+						mb.Mine(m_Node);
+					}
+					break;
+
+				case 2:
+					{
+						// switch to the longer branch. The cursor must be clamped to the fork point
+						m_bReorg = true;
+						m_hEvtNext = m_vAlt.front().m_Hdr.m_Height;
+
+						for (size_t i = 0; i < m_vAlt.size(); i++)
+							m_vAlt[i].Feed(m_Node);
+					}
+					break;
+
+				default:
+					verify_test(m_bReorg);
+					if (msg.m_HeightNext == m_vAlt.back().m_Hdr.m_Height + 1)
+					{
+						m_bDone = true;
+						io::Reactor::get_Current().stop();
+					}
+				}
+			}
+
+			virtual void OnMsg(proto::NewTip&& msg) override
+			{
+				if (m_nPushes && !m_bReorg)
+					// the events are pushed before the tip
+					verify_test(m_hEvtNext == msg.m_Description.m_Height + 1);
+			}
+		};
+
+		struct MyClient2
+			:public proto::NodeConnection
+		{
+			MyClient* m_pViewer;
+			io::Address m_Addr;
+			uint32_t m_nPushes = 0;
+			bool m_bSubscribed = false;
+
+			virtual void OnConnectedSecure() override
+			{
+				SendLogin();
+			}
+
+			virtual void OnDisconnect(const DisconnectReason&) override {
+				fail_test("OnDisconnect");
+			}
+
+			virtual void OnMsg(proto::NewTip&& msg) override
+			{
+				if (m_bSubscribed)
+					return;
+				m_bSubscribed = true;
+
+				// not a viewer. Must be ignored
+				proto::UtxoEventsSubscribe msgOut;
+				msgOut.m_HeightMin = 1;
+				msgOut.m_On = true;
+				Send(msgOut);
+
+				Send(proto::GetUtxoEvents(Zero));
+			}
+
+			virtual void OnMsg(proto::UtxoEvents&& msg) override
+			{
+				verify_test(msg.m_Events.empty()); // not authorized
+
+				// the subscription request is processed. Start the viewer
+				m_pViewer->Connect(m_Addr);
+			}
+
+			virtual void OnMsg(proto::UtxoEventsNew&&) override
+			{
+				m_nPushes++;
+			}
+		};
+
+		io::Address addr;
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+
+		MyClient cl(node, vAlt);
+
+		MyClient2 cl2;
+		cl2.m_pViewer = &cl;
+		cl2.m_Addr = addr;
+		cl2.Connect(addr);
+
+		io::Timer::Ptr pTimer = io::Timer::create(*pReactor);
+		pTimer->start(60 * 1000, false, []() { io::Reactor::get_Current().stop(); });
+
+		pReactor->run();
+
+		verify_test(cl.m_bDone);
+		verify_test(cl2.m_bSubscribed && !cl2.m_nPushes);
+	}
+
+
 	void TestChainworkProof()
 	{
 		printf("Preparing blockchain ...\n");
@@ -2042,6 +2495,15 @@ namespace beam
 			cwp2.m_LowerBound = cc.m_vStates[cc.m_vStates.size() - nStates].m_Hdr.m_ChainWork;
 			verify_test(cwp2.Crop(cwp));
 
+			// the same, without verifying the source states
+			Block::ChainWorkProof cwp3;
+			cwp3.m_LowerBound = cwp2.m_LowerBound;
+			verify_test(cwp3.Crop(cwp, true));
+			verify_test(cwp3.m_Heading.m_Prefix.m_Height == cwp2.m_Heading.m_Prefix.m_Height);
+			verify_test(cwp3.m_Heading.m_vElements.size() == cwp2.m_Heading.m_vElements.size());
+			verify_test(cwp3.m_vArbitraryStates.size() == cwp2.m_vArbitraryStates.size());
+			verify_test(cwp3.m_Proof.m_vData == cwp2.m_Proof.m_vData);
+
 			cwp.m_LowerBound = cwp2.m_LowerBound;
 			verify_test(cwp.Crop());
 
@@ -2316,6 +2778,12 @@ int main()
 	beam::TestNodeDB();
 	beam::DeleteFile(beam::g_sz);
 
+	printf("NodeDB upgrade test...\n");
+	fflush(stdout);
+
+	beam::TestNodeDBUpgrade(17);
+	beam::TestNodeDBUpgrade(18);
+
 	{
 		printf("NodeProcessor test1...\n");
 		fflush(stdout);
@@ -2354,6 +2822,13 @@ int main()
 	beam::DeleteFile(beam::g_sz);
 	beam::DeleteFile(beam::g_sz2);
 
+	printf("Node <---> Client UTXO events push test...\n");
+	fflush(stdout);
+
+	beam::TestNodeUtxoEventsPush();
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
 	printf("Node <---> FlyClient test...\n");
 	fflush(stdout);
 
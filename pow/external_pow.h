@@ -41,6 +41,13 @@ public:
         std::string apiKeysFile;
         std::string certFile;
         std::string privKeyFile;
+
+        // target seconds between shares of one miner, share difficulty is adjusted per connection.
+        // 0 means miners submit solutions at block difficulty only
+        unsigned shareInterval = 0;
+
+        // threads verifying submitted solutions, 0 = auto
+        unsigned verifyThreads = 0;
     };
 
     // creates stratum server
@@ -17,6 +17,7 @@
 #include "nlohmann/json.hpp"
 #include "utility/helpers.h"
 #include "utility/logger.h"
+#include <algorithm>
 
 using json = nlohmann::json;
 
@@ -164,6 +165,50 @@ bool append_json_msg(io::FragmentWriter& packer, const Job& m) {
     return serialize_json_msg(packer, o);
 }
 
+bool JobTemplate::init(const Job& job) {
+    clear();
+
+    io::SerializedMsg fragments;
+    io::FragmentWriter fw(1024, 0, [&fragments](io::SharedBuffer&& f) { fragments.push_back(std::move(f)); });
+    if (!append_json_msg(fw, job)) return false;
+
+    io::SharedBuffer buf = io::normalize(fragments);
+    const char* begin = (const char*)buf.data;
+    const char* end = begin + buf.size;
+
+    static const std::string key = std::string("\"") + l_difficulty + "\":";
+    const char* p = std::search(begin, end, key.begin(), key.end());
+    if (p == end) return false;
+    p += key.size();
+    const char* q = p;
+    while (q != end && *q >= '0' && *q <= '9') ++q;
+
+    _prefix.assign(begin, p - begin, buf.guard);
+    _suffix.assign(q, end - q, buf.guard);
+    _values[job.difficulty].assign(p, q - p, buf.guard);
+    return true;
+}
+
+const io::SerializedMsg& JobTemplate::get(uint32_t difficulty) {
+    io::SharedBuffer& value = _values[difficulty];
+    if (value.empty()) {
+        std::string s = std::to_string(difficulty);
+        value.assign(s.data(), s.size());
+    }
+    _msg.resize(3);
+    _msg[0] = _prefix;
+    _msg[1] = value;
+    _msg[2] = _suffix;
+    return _msg;
+}
+
+void JobTemplate::clear() {
+    _prefix.clear();
+    _suffix.clear();
+    _values.clear();
+    _msg.clear();
+}
+
 bool append_json_msg(io::FragmentWriter& packer, const Cancel& m) {
     json o;
     append_base(o, m);
@@ -16,6 +16,7 @@
 #include "core/block_crypt.h"
 #include "utility/io/fragment_writer.h"
 #include <string>
+#include <map>
 
 namespace beam::stratum {
 
@@ -107,6 +108,26 @@ struct Cancel : Message {
     {}
 };
 
+/// Serialized job split around the difficulty value.
+/// The same job with different (per-miner) difficulties shares all the fragments but the value
+struct JobTemplate {
+    /// Serializes the job, returns false on error
+    bool init(const Job& job);
+
+    /// Returns serialized job with given difficulty, valid until the next call
+    const io::SerializedMsg& get(uint32_t difficulty);
+
+    void clear();
+
+    bool empty() const { return _prefix.empty(); }
+
+private:
+    io::SharedBuffer _prefix; // up to the difficulty value
+    io::SharedBuffer _suffix; // after the difficulty value, incl. eol
+    std::map<uint32_t, io::SharedBuffer> _values; // serialized difficulty values
+    io::SerializedMsg _msg;
+};
+
 /// Miner posts a solution
 struct Solution : Message {
     std::string nonce;
@@ -18,6 +18,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 #define LOG_VERBOSE_ENABLED 1
 #include "utility/logger.h"
@@ -36,8 +38,19 @@ namespace stratum {
 
 static const uint64_t SERVER_RESTART_TIMER = 1;
 static const uint64_t ACL_REFRESH_TIMER = 2;
+static const uint64_t STATS_TIMER = 3;
 static const unsigned SERVER_RESTART_INTERVAL = 1000;
 static const unsigned ACL_REFRESH_INTERVAL = 5000;
+static const unsigned STATS_INTERVAL = 30000;
+
+static const size_t MAX_RECENT_JOBS = 3; // as many as the node accepts solutions for
+static const size_t MAX_PENDING_SHARES = 4096;
+
+// vardiff: retarget after this many shares or after this many share intervals
+static const uint32_t VARDIFF_WINDOW_SHARES = 16;
+// initial share difficulty is block difficulty divided by 2^VARDIFF_INITIAL_SHIFT
+static const uint32_t VARDIFF_INITIAL_SHIFT = 6;
+static const int VARDIFF_MAX_STEP = 2;
 
 static const char STS[] = "stratum server ";
 
@@ -59,6 +72,16 @@ Server::Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address
     if (_prefixDigits > 0) {
         ECC::GenRandom(&_prefixSeed, 8);
     }
+
+    unsigned nThreads = o.verifyThreads;
+    if (!nThreads) {
+        nThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1U, 4U);
+    }
+    _verifier = std::make_unique<ShareVerifier>(reactor, nThreads, [this](ShareTask&& task) {
+        on_share_verified(std::move(task));
+    });
+    _timers.set_timer(STATS_TIMER, STATS_INTERVAL, BIND_THIS_MEMFN(report_stats));
+    _flushEvent = io::AsyncEvent::create(reactor, BIND_THIS_MEMFN(flush_writes));
 }
 
 void Server::start_server() {
@@ -143,53 +166,315 @@ bool Server::on_login(uint64_t from, const Login& login) {
     if (!sent || !loginSuccess)
         return false;
 
-    return _connections[from]->send_msg(_recentJob.msg, true);
+    conn->shares.windowStart_ms = conn->shares.reportedAt_ms = local_timestamp_msec();
+    return send_job(*conn);
 }
 
 bool Server::on_solution(uint64_t from, const Solution& sol) {
 	LOG_DEBUG() << TRACE(sol.nonce) << TRACE(sol.output);
 
+	auto& conn = _connections[from];
+
 	if (_prefixDigits > 0) {
-	    const std::string& nonceprefix = _connections[from]->get_nonceprefix();
+	    const std::string& nonceprefix = conn->get_nonceprefix();
 	    if (
 	        sol.nonce.size() < _prefixDigits ||
 	        memcmp(sol.nonce.c_str(), nonceprefix.c_str(), _prefixDigits) != 0
 	    ) {
             Result res(sol.id, stratum::solution_rejected);
             //res.nonceprefix = nonceprefix;
-            append_json_msg(_fw, res);
-            _connections[from]->send_msg(_currentMsg, true, true);
-            _currentMsg.clear();
+            send_result(from, res, true);
             return false;
 	    }
 	}
 
-	_recentResult.id = sol.id;
-    sol.fill_pow(_recentResult.pow);
+    ShareAccounting& shares = conn->shares;
+
+    const JobInfo* job = find_job(sol.id);
+    auto itJob = shares.jobs.find(sol.id);
+    if (!job || itJob == shares.jobs.end()) {
+        ++shares.stale;
+        return send_result(from, Result(sol.id, stratum::solution_expired));
+    }
+    JobShares& jobShares = itJob->second;
+
+    ShareTask task;
+    task.connId = from;
+    task.jobId = sol.id;
+    task.input = job->input;
+    task.height = job->height;
+    task.pow = job->pow;
+    task.blockDifficulty = job->pow.m_Difficulty;
+
+    if (!sol.fill_pow(task.pow)) {
+        ++shares.rejected;
+        return send_result(from, Result(sol.id, stratum::solution_rejected));
+    }
+
+    // the same hash PoW::IsValid tests against the difficulty
+    ECC::Hash::Value hv;
+    ECC::Hash::Processor() << Blob(task.pow.m_Indices.data(), (uint32_t) task.pow.m_Indices.size()) >> hv;
+
+    if (!jobShares.solutions.insert(hv).second) {
+        ++shares.duplicate;
+        return send_result(from, Result(sol.id, stratum::solution_rejected));
+    }
+
+    // the share difficulty this job was sent with, so shares mined before a retarget are still accepted
+    task.pow.m_Difficulty = std::min(jobShares.difficulty.m_Packed, task.blockDifficulty.m_Packed);
+    if (!task.pow.m_Difficulty.IsTargetReached(hv)) {
+        ++shares.rejected;
+        return send_result(from, Result(sol.id, stratum::solution_rejected));
+    }
+
+    task.isBlock = task.blockDifficulty.IsTargetReached(hv);
+
+    if (!_verifier->push(std::move(task))) {
+        LOG_WARNING() << STS << "too many pending solutions, rejecting solution from " << io::Address::from_u64(from);
+        ++shares.rejected;
+        return send_result(from, Result(sol.id, stratum::solution_rejected));
+    }
+
+    return true;
+}
+
+void Server::on_share_verified(ShareTask&& task) {
+    auto it = _connections.find(task.connId);
+    Connection* conn = (it != _connections.end()) ? it->second.get() : nullptr;
+
+    Result res(task.jobId, stratum::solution_rejected);
+
+    if (task.valid) {
+        if (conn) {
+            ShareAccounting& shares = conn->shares;
+            ++shares.accepted;
+            ++shares.windowShares;
+            shares.work += task.pow.m_Difficulty.ToFloat();
+        }
+        res = Result(task.jobId, stratum::solution_accepted);
+
+        // block-level solutions go to the node regardless of the miner connection state
+        if (task.isBlock) {
+            submit_block(task, res);
+        }
+    } else {
+        LOG_INFO() << STS << "invalid solution to " << task.jobId << " from " << io::Address::from_u64(task.connId);
+        if (conn) ++conn->shares.rejected;
+    }
+
+    if (!conn) return;
+
+    if (!send_result(task.connId, res)) {
+        on_bad_peer(task.connId);
+        return;
+    }
+
+    if (task.valid) {
+        adjust_difficulty(*conn);
+    }
+}
+
+void Server::submit_block(const ShareTask& task, Result& res) {
+    const JobInfo* job = find_job(task.jobId);
+    if (!job) {
+        res = Result(task.jobId, stratum::solution_expired);
+        return;
+    }
+
+    _recentResult.id = task.jobId;
+    _recentResult.height = task.height;
+    _recentResult.pow = task.pow;
+    _recentResult.pow.m_Difficulty = task.blockDifficulty;
 
-    LOG_INFO() << STS << "solution to " << sol.id << " from " << io::Address::from_u64(from);
-	IExternalPOW::BlockFoundResult result = _recentResult.onBlockFound();
+    LOG_INFO() << STS << "solution to " << task.jobId << " from " << io::Address::from_u64(task.connId);
+	IExternalPOW::BlockFoundResult result = job->onBlockFound();
     stratum::ResultCode stratumCode = stratum::solution_rejected;
     if (result == IExternalPOW::solution_accepted) {
         stratumCode = stratum::solution_accepted;
     } else if (result == IExternalPOW::solution_expired) {
         stratumCode = stratum::solution_expired;
     }
-    Result res(sol.id, stratumCode);
+    res = Result(task.jobId, stratumCode);
     if (result == IExternalPOW::solution_accepted) {
         res.blockhash = result._blockhash;
     }
+}
+
+void Server::adjust_difficulty(Connection& conn) {
+    if (!_options.shareInterval || _jobs.empty()) return;
+
+    ShareAccounting& shares = conn.shares;
+    if (shares.difficulty.m_Packed == Difficulty::s_Inf) return; // no job sent yet
+
+    uint64_t now = local_timestamp_msec();
+    uint64_t elapsed = now - shares.windowStart_ms;
+    uint64_t interval = uint64_t(_options.shareInterval) * 1000;
+
+    if (shares.windowShares < VARDIFF_WINDOW_SHARES && elapsed < interval * VARDIFF_WINDOW_SHARES) return;
+
+    // ratio > 1 means shares come too often
+    double ratio = elapsed ? double(interval) * shares.windowShares / elapsed : VARDIFF_WINDOW_SHARES;
+    int step = -VARDIFF_MAX_STEP;
+    if (ratio > 0) {
+        step = std::clamp(int(std::floor(std::log2(ratio))), -VARDIFF_MAX_STEP, VARDIFF_MAX_STEP);
+    }
+
+    shares.windowShares = 0;
+    shares.windowStart_ms = now;
+
+    if (!step) return;
+
+    uint32_t order, mantissa;
+    shares.difficulty.Unpack(order, mantissa);
+    int newOrder = std::max(int(order) + step, 0);
+
+    Difficulty d;
+    d.Pack(uint32_t(newOrder), mantissa);
+    d = std::min(d.m_Packed, _jobs.front().pow.m_Difficulty.m_Packed);
+    if (d.m_Packed == shares.difficulty.m_Packed) return;
+
+    LOG_DEBUG() << STS << "share difficulty for " << io::Address::from_u64(conn.get_id()) << " " << shares.difficulty << " -> " << d;
+
+    shares.difficulty = d;
+    if (!send_job(conn)) {
+        _deadConnections.push_back(conn.get_id());
+    }
+}
+
+bool Server::send_result(uint64_t to, const Result& res, bool shutdown) {
     append_json_msg(_fw, res);
-    bool sent = _connections[from]->send_msg(_currentMsg, true);
+    bool sent = _connections[to]->send_msg(_currentMsg, true, shutdown);
     _currentMsg.clear();
     return sent;
 }
 
+bool Server::send_job(Connection& conn) {
+    if (_jobs.empty()) {
+        return conn.send_msg(_recentJob.msg, true);
+    }
+
+    const JobInfo& job = _jobs.front();
+    ShareAccounting& shares = conn.shares;
+
+    if (!_options.shareInterval) {
+        shares.difficulty = job.pow.m_Difficulty;
+    } else if (shares.difficulty.m_Packed == Difficulty::s_Inf) {
+        // first job for this miner
+        uint32_t order, mantissa;
+        job.pow.m_Difficulty.Unpack(order, mantissa);
+        shares.difficulty.Pack(order > VARDIFF_INITIAL_SHIFT ? order - VARDIFF_INITIAL_SHIFT : 0, mantissa);
+    }
+
+    if (shares.difficulty.m_Packed > job.pow.m_Difficulty.m_Packed) {
+        shares.difficulty = job.pow.m_Difficulty;
+    }
+
+    // a job resent after a retarget keeps accepting shares at the lower difficulty
+    auto ib = shares.jobs.emplace(job.id, JobShares());
+    JobShares& jobShares = ib.first->second;
+    if (ib.second || shares.difficulty.m_Packed < jobShares.difficulty.m_Packed) {
+        jobShares.difficulty = shares.difficulty;
+    }
+
+    if (shares.difficulty.m_Packed == job.pow.m_Difficulty.m_Packed || _recentJob.tmpl.empty()) {
+        return conn.send_msg(_recentJob.msg, true);
+    }
+
+    // shares the job fragments, only the difficulty value differs
+    return conn.send_msg(_recentJob.tmpl.get(shares.difficulty.m_Packed), true);
+}
+
+const Server::JobInfo* Server::find_job(const std::string& id) const {
+    for (const auto& job : _jobs) {
+        if (job.id == id) return &job;
+    }
+    return nullptr;
+}
+
+Server::Stats Server::get_stats() const {
+    Stats stats;
+    for (const auto& p : _connections) {
+        const Connection& conn = *p.second;
+        if (!conn.is_logged_in()) continue;
+
+        ++stats.miners;
+        stats.accepted += conn.shares.accepted;
+        stats.rejected += conn.shares.rejected;
+        stats.stale += conn.shares.stale;
+        stats.duplicate += conn.shares.duplicate;
+    }
+    return stats;
+}
+
+void Server::report_stats() {
+    uint64_t now = local_timestamp_msec();
+    double hashrateTotal = 0;
+
+    for (auto& p : _connections) {
+        Connection& conn = *p.second;
+        if (!conn.is_logged_in()) continue;
+
+        adjust_difficulty(conn);
+
+        ShareAccounting& shares = conn.shares;
+        double dt = (now - shares.reportedAt_ms) / 1000.0;
+        double hashrate = (dt > 0) ? shares.work / dt : 0;
+        hashrateTotal += hashrate;
+
+        LOG_DEBUG() << STS << "miner " << io::Address::from_u64(p.first)
+            << " difficulty=" << shares.difficulty
+            << " accepted=" << shares.accepted
+            << " rejected=" << shares.rejected
+            << " stale=" << shares.stale
+            << " duplicate=" << shares.duplicate
+            << " hashrate=" << hashrate << " sol/s";
+
+        shares.work = 0;
+        shares.reportedAt_ms = now;
+    }
+
+    for (auto c : _deadConnections) {
+        _connections.erase(c);
+    }
+    _deadConnections.clear();
+
+    Stats stats = get_stats();
+    if (stats.miners) {
+        LOG_INFO() << STS << stats.miners << " miners"
+            << " accepted=" << stats.accepted
+            << " rejected=" << stats.rejected
+            << " stale=" << stats.stale
+            << " duplicate=" << stats.duplicate
+            << " hashrate=" << hashrateTotal << " sol/s";
+    }
+
+    _timers.set_timer(STATS_TIMER, STATS_INTERVAL, BIND_THIS_MEMFN(report_stats));
+}
+
 void Server::on_bad_peer(uint64_t from) {
     LOG_INFO() << STS << "-peer " << io::Address::from_u64(from);
     _connections.erase(from);
 }
 
+void Server::on_unflushed(uint64_t from) {
+    if (_unflushed.empty()) {
+        _flushEvent->post();
+    }
+    _unflushed.push_back(from);
+}
+
+void Server::flush_writes() {
+    // a job fan-out or a batch of verified shares goes out as one write per connection
+    std::vector<uint64_t> unflushed;
+    unflushed.swap(_unflushed);
+    for (auto id : unflushed) {
+        auto it = _connections.find(id);
+        if (it != _connections.end() && !it->second->flush()) {
+            on_bad_peer(id);
+        }
+    }
+}
+
 void Server::new_job(
     const std::string& id,
     const Merkle::Hash& input,
@@ -199,18 +484,38 @@ void Server::new_job(
     const CancelCallback& /* cancelCallback */
 ) {
     _recentJob.id = id;
-    _recentResult.onBlockFound = callback;
-    _recentResult.height = height;	
+
+    JobInfo job;
+    job.id = id;
+    job.input = input;
+    job.pow = pow;
+    job.height = height;
+    job.onBlockFound = callback;
+    _jobs.push_front(std::move(job));
+    if (_jobs.size() > MAX_RECENT_JOBS) {
+        _jobs.pop_back();
+    }
 
     LOG_INFO() << STS << "new job " << id << " will be sent to " << _connections.size() << " connected peers";
 
     Job jobMsg(id, input, pow, height);
-    append_json_msg(_fw, jobMsg);
-	_recentJob.msg.swap(_currentMsg);
-    _currentMsg.clear();
+    if (_recentJob.tmpl.init(jobMsg)) {
+        _recentJob.msg = _recentJob.tmpl.get(jobMsg.difficulty);
+    } else {
+        LOG_ERROR() << STS << "cannot serialize job " << id;
+        append_json_msg(_fw, jobMsg);
+        _recentJob.msg.swap(_currentMsg);
+        _currentMsg.clear();
+    }
 
     for (auto& p : _connections) {
-        if (!p.second->send_msg(_recentJob.msg, true)) {
+        // forget shares of jobs that are no longer accepted
+        auto& jobs = p.second->shares.jobs;
+        for (auto it = jobs.begin(); it != jobs.end(); ) {
+            if (find_job(it->first)) ++it; else it = jobs.erase(it);
+        }
+
+        if (!send_job(*p.second)) {
             _deadConnections.push_back(p.first);
         }
     }
@@ -231,6 +536,7 @@ void Server::get_last_found_block(std::string& jobID, Height& jobHeight, Block::
 
 void Server::stop_current() {
     _recentJob.id.clear();
+    _jobs.clear();
 }
 
 void Server::stop() {
@@ -238,6 +544,73 @@ void Server::stop() {
     _server.reset();
 }
 
+Server::ShareVerifier::ShareVerifier(io::Reactor& reactor, unsigned nThreads, OnVerified&& onVerified) :
+    _onVerified(std::move(onVerified))
+{
+    _resultsEvent = io::AsyncEvent::create(reactor, BIND_THIS_MEMFN(on_results));
+    for (unsigned i = 0; i < nThreads; i++) {
+        _threads.emplace_back(&ShareVerifier::thread_func, this);
+    }
+}
+
+Server::ShareVerifier::~ShareVerifier() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _newTask.notify_all();
+    for (auto& t : _threads) {
+        t.join();
+    }
+}
+
+bool Server::ShareVerifier::push(ShareTask&& task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (task.isBlock) {
+            _tasks.push_front(std::move(task));
+        } else {
+            if (_tasks.size() >= MAX_PENDING_SHARES) return false;
+            _tasks.push_back(std::move(task));
+        }
+    }
+    _newTask.notify_one();
+    return true;
+}
+
+void Server::ShareVerifier::thread_func() {
+    while (true) {
+        ShareTask task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _newTask.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+            if (_stop) return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        // difficulty was tested on the reactor, so FakePoW skips the solution check only, as the node does
+        task.valid = Rules::get().FakePoW || task.pow.IsValid(task.input.m_pData, task.input.nBytes, task.height);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _results.push_back(std::move(task));
+        }
+        _resultsEvent->post();
+    }
+}
+
+void Server::ShareVerifier::on_results() {
+    std::deque<ShareTask> results;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        results.swap(_results);
+    }
+    for (auto& task : results) {
+        _onVerified(std::move(task));
+    }
+}
+
 Server::AccessControl::AccessControl(const std::string &keysFileName) :
     _enabled(!keysFileName.empty()),
     _keysFileName(keysFileName),
@@ -288,7 +661,8 @@ Server::Connection::Connection(
     _nonceprefix(std::move(nonceprefix)),
     _stream(std::move(newStream)),
     _lineReader(BIND_THIS_MEMFN(on_raw_message)),
-    _loggedIn(false)
+    _loggedIn(false),
+    _unflushed(false)
 {
     _stream->enable_keepalive(2);
     _stream->enable_read(BIND_THIS_MEMFN(on_stream_data));
@@ -309,11 +683,20 @@ bool Server::Connection::on_stream_data(io::ErrorCode errorCode, void* data, siz
 
 bool Server::Connection::send_msg(const io::SerializedMsg& msg, bool onlyIfLoggedIn, bool shutdown) {
     if (onlyIfLoggedIn && !_loggedIn) return true;
-    bool sent = _stream && _stream->write(msg);
-    if (sent && shutdown) {
+    bool sent = _stream && _stream->write(msg, false);
+    if (!sent) return false;
+    if (shutdown) {
         _stream->shutdown();
+    } else if (!_unflushed) {
+        _unflushed = true;
+        _owner.on_unflushed(_id);
     }
-    return sent;
+    return true;
+}
+
+bool Server::Connection::flush() {
+    _unflushed = false;
+    return _stream && _stream->write(io::SerializedMsg());
 }
 
 bool Server::Connection::on_message(const stratum::Login& login) {
@@ -18,8 +18,13 @@
 #include "p2p/line_protocol.h"
 #include "utility/io/tcpserver.h"
 #include "utility/io/coarsetimer.h"
+#include "utility/io/asyncevent.h"
 #include <set>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace beam { namespace stratum {
 
@@ -29,13 +34,95 @@ struct ConnectionToServer {
     virtual bool on_login(uint64_t from, const Login& login) = 0;
     virtual bool on_solution(uint64_t from, const Solution& solution) = 0;
     virtual void on_bad_peer(uint64_t from) = 0;
+    virtual void on_unflushed(uint64_t from) = 0;
 };
 
 class Server : public IExternalPOW, public ConnectionToServer {
 public:
     Server(const IExternalPOW::Options& o, io::Reactor& reactor, io::Address listenTo, unsigned noncePrefixDigits);
 
+    // Share totals over the logged in miners
+    struct Stats {
+        size_t miners = 0;
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t stale = 0;
+        uint64_t duplicate = 0;
+    };
+
+    Stats get_stats() const;
+
 private:
+    // Share difficulty a job was sent to the miner with, and the solutions submitted to it
+    struct JobShares {
+        Difficulty difficulty;
+        std::set<ECC::Hash::Value> solutions; // hashes of submitted indices, to reject duplicates
+    };
+
+    // Per-miner share difficulty and statistics
+    struct ShareAccounting {
+        Difficulty difficulty = Difficulty(Difficulty::s_Inf); // s_Inf until the first job is sent
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t stale = 0;
+        uint64_t duplicate = 0;
+        double work = 0; // sum of accepted share difficulties since last report
+        uint64_t reportedAt_ms = 0;
+
+        // vardiff window
+        uint32_t windowShares = 0;
+        uint64_t windowStart_ms = 0;
+
+        std::map<std::string, JobShares> jobs; // job id -> shares, only for the recent jobs sent to this miner
+    };
+
+    struct JobInfo {
+        std::string id;
+        Merkle::Hash input;
+        Block::PoW pow;
+        Height height = 0;
+        BlockFound onBlockFound;
+    };
+
+    struct ShareTask {
+        uint64_t connId = 0;
+        std::string jobId;
+        Merkle::Hash input;
+        Height height = 0;
+        Block::PoW pow; // submitted solution, m_Difficulty is the share difficulty
+        Difficulty blockDifficulty;
+
+        bool isBlock = false; // indices hash reaches block difficulty
+
+        // set by verifier
+        bool valid = false;
+    };
+
+    // Verifies shares on worker threads, results are delivered to the reactor thread
+    class ShareVerifier {
+    public:
+        using OnVerified = std::function<void(ShareTask&&)>;
+
+        ShareVerifier(io::Reactor& reactor, unsigned nThreads, OnVerified&& onVerified);
+        ~ShareVerifier();
+
+        // block candidates are verified first and never dropped, others are rejected if the queue is full
+        bool push(ShareTask&& task);
+
+    private:
+        void thread_func();
+        void on_results();
+
+        std::mutex _mutex;
+        std::condition_variable _newTask;
+        std::deque<ShareTask> _tasks;
+        std::deque<ShareTask> _results;
+        bool _stop = false;
+        OnVerified _onVerified;
+        io::AsyncEvent::Ptr _resultsEvent;
+        std::vector<std::thread> _threads;
+    };
+
     class AccessControl {
     public:
         explicit AccessControl(const std::string& keysFileName);
@@ -58,8 +145,17 @@ private:
 
         const std::string& get_nonceprefix() { return _nonceprefix; }
 
+        bool is_logged_in() const { return _loggedIn; }
+
+        uint64_t get_id() const { return _id; }
+
+        ShareAccounting shares;
+
+        // queues the message, writes are flushed once per reactor cycle unless shutting down
         bool send_msg(const io::SerializedMsg& msg, bool onlyIfLoggedIn, bool shutdown=false);
 
+        bool flush();
+
     private:
         bool on_message(const Login& login) override;
 
@@ -79,6 +175,7 @@ private:
         io::TcpStream::Ptr _stream;
         LineReader _lineReader;
         bool _loggedIn;
+        bool _unflushed;
     };
 
     void start_server();
@@ -92,6 +189,16 @@ private:
     bool on_login(uint64_t from, const Login& login) override;
     bool on_solution(uint64_t from, const Solution& solution) override;
     void on_bad_peer(uint64_t from) override;
+    void on_unflushed(uint64_t from) override;
+    void flush_writes();
+
+    void on_share_verified(ShareTask&& task);
+    void submit_block(const ShareTask& task, Result& res);
+    void adjust_difficulty(Connection& conn);
+    bool send_result(uint64_t to, const Result& res, bool shutdown=false);
+    bool send_job(Connection& conn);
+    const JobInfo* find_job(const std::string& id) const;
+    void report_stats();
 
     void new_job(
         const std::string&,
@@ -117,19 +224,26 @@ private:
 	struct RecentJob {
 		io::SerializedMsg msg;
 		std::string id;
+		JobTemplate tmpl;
 	} _recentJob;
 
 	struct RecentResult {
 		std::string id;
 		Height height;
 		Block::PoW pow;
-		BlockFound onBlockFound;
 	} _recentResult;
 
+    std::deque<JobInfo> _jobs; // recent jobs, the current one is at front
+
     io::SerializedMsg _currentMsg;
     std::vector<uint64_t> _deadConnections;
+    std::vector<uint64_t> _unflushed; // connections with queued writes
+    io::AsyncEvent::Ptr _flushEvent;
     unsigned _prefixDigits; // nonceprefix hex digits, 0..6
     uint64_t _prefixSeed;
+
+    // must be destroyed first, its threads refer to this
+    std::unique_ptr<ShareVerifier> _verifier;
 };
 
 }} //namespaces
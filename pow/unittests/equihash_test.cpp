@@ -89,9 +89,44 @@ void TestArrayExpanding()
     TestArrayExpanding(96, 5);
 }
 
+void TestGenerateHashes()
+{
+    cout << "Test lane hashes...\n";
+
+    EquihashR<150,5,3> eh;
+    const size_t hLen = 3 * GetSizeInBytes(150);
+
+    // lengths around the block size: the index in the same block, in the next one, and after a full block
+    for (size_t nInput : { 0, 5, 40, 123, 124, 125, 128, 132, 300 })
+    {
+        eh_HashState base;
+        eh.InitialiseState(base);
+
+        vector<uint8_t> input(nInput);
+        for (size_t i = 0; i < nInput; i++)
+            input[i] = uint8_t(rand());
+        blake2b_update(&base, input.data(), input.size());
+
+        vector<eh_index> vG = { 0, 1, 15, 16, 17, 31, 0x12345, 0x3ffff0, 0x3fffff };
+        for (int i = 0; i < 23; i++)
+            vG.push_back(eh_index(rand()) & 0x3fffff);
+
+        vector<uint8_t> hashes(vG.size() * hLen);
+        GenerateHashes(base, vG.data(), vG.size(), hashes.data(), hLen, 150, 3);
+
+        for (size_t k = 0; k < vG.size(); k++)
+        {
+            uint8_t hash[hLen];
+            GenerateHash(base, vG[k], hash, hLen, 150, 3);
+            WALLET_CHECK(equal(hash, hash + hLen, &hashes[k * hLen]));
+        }
+    }
+}
+
 int main()
 {
     TestArrayExpanding();
+    TestGenerateHashes();
     
     // commented since it doesn't complete in 10 minutes and failes auto tests
 /*
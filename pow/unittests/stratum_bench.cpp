@@ -0,0 +1,179 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Job refresh latency: time from new_job until every connected miner has received the job.
+// Usage: stratum_bench [connections...], default 10 100 1000 10000.
+// Miners and the server share one reactor, so ulimit -n must allow 2 descriptors per miner.
+
+#include "pow/stratum.h"
+#include "pow/stratum_server.h"
+#include "core/ecc.h"
+#include "utility/io/timer.h"
+#include "utility/config.h"
+#include "utility/helpers.h"
+#include "utility/logger.h"
+#include <algorithm>
+
+using namespace beam;
+
+namespace {
+
+const io::Address g_Addr = io::Address::localhost().port(20200);
+const unsigned JOBS_PER_RUN = 10;
+const size_t LOGIN_BATCH = 1000; // below the listen backlog
+
+struct Miners {
+    io::Reactor& reactor;
+    std::vector<io::TcpStream::Ptr> streams;
+    size_t connected = 0;
+    size_t failed = 0;
+    uint64_t lines = 0;
+    uint64_t awaitLines = 0;
+
+    explicit Miners(io::Reactor& r) : reactor(r) {}
+
+    // runs the reactor until miners received awaitLines lines in total, or timeout
+    bool wait(uint64_t nLines) {
+        awaitLines = nLines;
+        io::Timer::Ptr timer = io::Timer::create(reactor);
+        timer->start(60000, false, [this]() { reactor.stop(); });
+        if (lines < awaitLines) reactor.run();
+        return lines >= awaitLines;
+    }
+
+    bool on_data(io::ErrorCode what, void* data, size_t size) {
+        if (what) {
+            reactor.stop();
+            return false;
+        }
+        lines += std::count((const char*)data, (const char*)data + size, '\n');
+        if (lines >= awaitLines) reactor.stop();
+        return true;
+    }
+
+    // connects and logs in n more miners, each gets the login result and the current job
+    bool login(size_t n) {
+        size_t first = streams.size();
+        streams.resize(first + n);
+        for (size_t i = first; i < streams.size(); i++) {
+            reactor.tcp_connect(g_Addr, i, [this](uint64_t tag, io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+                if (errorCode) {
+                    ++failed;
+                } else {
+                    streams[tag] = std::move(newStream);
+                    streams[tag]->enable_read(BIND_THIS_MEMFN(on_data));
+                    ++connected;
+                }
+                if (connected + failed == streams.size()) reactor.stop();
+            });
+        }
+        reactor.run();
+        if (failed) return false;
+
+        io::SerializedMsg m;
+        LineProtocol packer(
+            [](void*, size_t) -> bool { return false; },
+            [&m](io::SharedBuffer&& fragment) { m.push_back(fragment); }
+        );
+        stratum::append_json_msg(packer, stratum::Login("bench"));
+        for (size_t i = first; i < streams.size(); i++) {
+            streams[i]->write(m);
+        }
+        return wait(lines + 2 * n);
+    }
+};
+
+int run(io::Reactor& reactor, IExternalPOW& server, size_t nMiners, unsigned& jobId) {
+    Merkle::Hash input;
+    Block::PoW pow;
+    pow.m_Difficulty.Pack(30, 1U << Difficulty::s_MantissaBits);
+
+    Miners miners(reactor);
+    for (size_t n = 0; n < nMiners; n += LOGIN_BATCH) {
+        if (!miners.login(std::min(LOGIN_BATCH, nMiners - n))) {
+            LOG_ERROR() << "cannot log in " << nMiners << " miners, check ulimit -n";
+            return 1;
+        }
+    }
+
+    uint64_t total = 0, worst = 0;
+    for (unsigned i = 0; i < JOBS_PER_RUN; i++) {
+        ECC::GenRandom(input.m_pData, input.nBytes);
+
+        ++jobId;
+        uint64_t t = local_timestamp_msec();
+        server.new_job(std::to_string(jobId), input, pow, jobId, []() { return IExternalPOW::solution_rejected; }, []() { return false; });
+        if (!miners.wait(miners.lines + nMiners)) {
+            LOG_ERROR() << "job " << jobId << " did not reach all miners";
+            return 1;
+        }
+        t = local_timestamp_msec() - t;
+
+        total += t;
+        worst = std::max(worst, t);
+    }
+
+    LOG_INFO() << "job refresh to " << nMiners << " miners: avg " << total / JOBS_PER_RUN << " ms, max " << worst << " ms";
+
+    // let the server notice the disconnects before the next run
+    miners.streams.clear();
+    io::Timer::Ptr timer = io::Timer::create(reactor);
+    timer->start(500, false, [&reactor]() { reactor.stop(); });
+    reactor.run();
+    return 0;
+}
+
+} //namespace
+
+int main(int argc, char* argv[]) {
+    auto logger = Logger::create(LOG_LEVEL_INFO, LOG_LEVEL_INFO);
+
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back(std::stoul(argv[i]));
+    }
+    if (counts.empty()) {
+        counts = { 10, 100, 1000, 10000 };
+    }
+
+    Config config;
+    config.set<Config::Int>("io.tcp_listen_backlog", 2000);
+    reset_global_config(std::move(config));
+
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    // per-miner share difficulty, so jobs go out from the template
+    IExternalPOW::Options options;
+    options.shareInterval = 10;
+    stratum::Server server(options, *reactor, g_Addr, 0);
+
+    unsigned jobId = 1;
+    Merkle::Hash input = Zero;
+    Block::PoW pow;
+    pow.m_Difficulty.Pack(30, 1U << Difficulty::s_MantissaBits);
+    IExternalPOW& externalPow = server;
+    externalPow.new_job(std::to_string(jobId), input, pow, jobId, []() { return IExternalPOW::solution_rejected; }, []() { return false; });
+
+    // let it start listening
+    io::Timer::Ptr timer = io::Timer::create(*reactor);
+    timer->start(300, false, [&reactor]() { reactor->stop(); });
+    reactor->run();
+
+    int res = 0;
+    for (size_t n : counts) {
+        res += run(*reactor, externalPow, n, jobId);
+    }
+    return res;
+}
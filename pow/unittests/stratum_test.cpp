@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #include "pow/stratum.h"
+#include "pow/stratum_server.h"
 #include "core/ecc.h"
 #include "utility/io/json_serializer.h"
 #include "p2p/line_protocol.h"
+#include "utility/io/timer.h"
 #include "utility/helpers.h"
 #include "utility/logger.h"
 
@@ -61,6 +63,232 @@ int json_creation_test() {
     return nErrors;
 }
 
+int job_template_test() {
+    int nErrors = 0;
+
+    using namespace beam::stratum;
+
+    Block::PoW pow;
+    pow.m_Difficulty.m_Packed = 0x0d123456;
+    Merkle::Hash hash;
+    for (uint32_t i = 0; i < hash.nBytes; i++) hash.m_pData[i] = uint8_t(i * 7);
+
+    Job jobMsg("1234", hash, pow, 400500);
+    JobTemplate tmpl;
+    if (!tmpl.init(jobMsg)) {
+        LOG_ERROR() << "cannot create job template";
+        return 1;
+    }
+
+    const uint32_t difficulties[] = { jobMsg.difficulty, 0, 7, 0x0a000000, 0x0d123456, 0xffffffff };
+    for (uint32_t d : difficulties) {
+        io::SharedBuffer buf = io::normalize(tmpl.get(d));
+        Job x;
+        auto code = parse_json_msg(buf.data, buf.size, x);
+        if (code != 0 || x.difficulty != d || x.input != jobMsg.input || x.height != jobMsg.height || x.id != jobMsg.id) {
+            LOG_ERROR() << "job template mismatch for difficulty " << d << ": " << to_string(buf);
+            ++nErrors;
+        }
+    }
+
+    return nErrors;
+}
+
+/// Miner side of the protocol, runs the reactor until the awaited messages arrive
+struct TestMiner : stratum::ParserCallback {
+    io::Reactor& reactor;
+    io::TcpStream::Ptr stream;
+    LineReader lineReader;
+    std::vector<stratum::Result> results;
+    std::vector<stratum::Job> jobs;
+    size_t awaitResults = 0;
+    size_t awaitJobs = 0;
+    io::SerializedMsg m;
+    LineProtocol packer;
+
+    explicit TestMiner(io::Reactor& r) :
+        reactor(r),
+        lineReader([this](void* data, size_t size) { return stratum::parse_json_msg(data, size, *this); }),
+        packer(
+            [](void*, size_t) -> bool { return false; },
+            [this](io::SharedBuffer&& fragment) { m.push_back(fragment); }
+        )
+    {}
+
+    bool connect(const io::Address& addr) {
+        reactor.tcp_connect(addr, 1, [this](uint64_t, io::TcpStream::Ptr&& newStream, io::ErrorCode errorCode) {
+            if (!errorCode) {
+                stream = std::move(newStream);
+                stream->enable_read([this](io::ErrorCode what, void* data, size_t size) {
+                    if (what || !lineReader.new_data_from_stream(data, size)) {
+                        stream.reset();
+                        reactor.stop();
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            reactor.stop();
+        });
+        reactor.run();
+        return stream.get() != nullptr;
+    }
+
+    template <typename Msg> void send(const Msg& msg) {
+        stratum::append_json_msg(packer, msg);
+        if (stream) stream->write(m);
+        m.clear();
+    }
+
+    // runs the reactor until there are nResults results and nJobs jobs received, or timeout
+    bool wait(size_t nResults, size_t nJobs) {
+        awaitResults = nResults;
+        awaitJobs = nJobs;
+        io::Timer::Ptr timer = io::Timer::create(reactor);
+        timer->start(5000, false, [this]() { reactor.stop(); });
+        if (!done()) reactor.run();
+        return done();
+    }
+
+    const stratum::Result& submit(const std::string& jobId, const Block::PoW& pow) {
+        send(stratum::Solution(jobId, pow));
+        wait(results.size() + 1, jobs.size());
+        static const stratum::Result noResult;
+        return results.empty() ? noResult : results.back();
+    }
+
+    bool done() const { return results.size() >= awaitResults && jobs.size() >= awaitJobs; }
+
+    void on_received() {
+        if (done()) reactor.stop();
+    }
+
+    bool on_message(const stratum::Result& r) override {
+        results.push_back(r);
+        on_received();
+        return true;
+    }
+
+    bool on_message(const stratum::Job& j) override {
+        jobs.push_back(j);
+        on_received();
+        return true;
+    }
+};
+
+/// Random solution whose indices hash reaches dMin but not dMax
+Block::PoW make_share(Difficulty dMin, Difficulty dMax) {
+    Block::PoW pow;
+    while (true) {
+        ECC::GenRandom(&pow.m_Nonce, Block::PoW::NonceType::nBytes);
+        ECC::GenRandom(pow.m_Indices.data(), Block::PoW::nSolutionBytes);
+        ECC::Hash::Value hv;
+        ECC::Hash::Processor() << Blob(pow.m_Indices.data(), (uint32_t) pow.m_Indices.size()) >> hv;
+        if (dMin.IsTargetReached(hv) && !dMax.IsTargetReached(hv)) return pow;
+    }
+}
+
+Difficulty make_difficulty(uint32_t order) {
+    Difficulty d;
+    d.Pack(order, 1U << Difficulty::s_MantissaBits);
+    return d;
+}
+
+int server_test() {
+    int nErrors = 0;
+
+    using namespace beam::stratum;
+
+#define verify_test(x) if (!(x)) { LOG_ERROR() << "check failed: " << #x << " line " << __LINE__; ++nErrors; }
+
+    // solutions are not solved here, the server tests only the indices hash against the difficulty
+    Rules::get().FakePoW = true;
+
+    io::Reactor::Ptr reactor = io::Reactor::create();
+    io::Reactor::Scope scope(*reactor);
+
+    IExternalPOW::Options options;
+    options.shareInterval = 1;
+    options.verifyThreads = 1;
+    io::Address addr = io::Address::localhost().port(20100);
+    Server server(options, *reactor, addr, 0);
+    IExternalPOW& externalPow = server;
+
+    const Difficulty dBlock = make_difficulty(8);
+    const Difficulty dShare0 = make_difficulty(2); // dBlock >> VARDIFF_INITIAL_SHIFT
+    const Difficulty dShare1 = make_difficulty(4); // after one maximal vardiff step
+    const Difficulty dNever = Difficulty(Difficulty::s_Inf);
+
+    unsigned nBlocksFound = 0;
+    auto onBlockFound = [&nBlocksFound]() {
+        ++nBlocksFound;
+        return IExternalPOW::BlockFoundResult(IExternalPOW::solution_accepted);
+    };
+
+    Merkle::Hash input;
+    ECC::GenRandom(input.m_pData, input.nBytes);
+    Block::PoW pow;
+    pow.m_Difficulty = dBlock;
+    externalPow.new_job("1", input, pow, 100, onBlockFound, []() { return false; });
+
+    // let it start listening
+    io::Timer::Ptr timer = io::Timer::create(*reactor);
+    timer->start(300, false, [&reactor]() { reactor->stop(); });
+    reactor->run();
+
+    TestMiner miner(*reactor);
+    if (!miner.connect(addr)) {
+        LOG_ERROR() << "cannot connect to stratum server";
+        return 1;
+    }
+
+    miner.send(Login("x"));
+    verify_test(miner.wait(1, 1));
+    verify_test(!miner.jobs.empty() && miner.jobs.back().difficulty == dShare0.m_Packed);
+
+    // verifier round trip
+    Block::PoW share = make_share(dShare0, dBlock);
+    verify_test(miner.submit("1", share).code == solution_accepted);
+
+    // duplicate and stale
+    verify_test(miner.submit("1", share).code == solution_rejected);
+    verify_test(miner.submit("2", make_share(dShare0, dBlock)).code == solution_expired);
+
+    // below the share difficulty
+    verify_test(miner.submit("1", make_share(Difficulty(0), dShare0)).code == solution_rejected);
+
+    Server::Stats stats = server.get_stats();
+    verify_test(stats.miners == 1 && stats.accepted == 1 && stats.duplicate == 1 && stats.stale == 1 && stats.rejected == 1);
+
+    // vardiff: shares come much more often than shareInterval, the job is resent at higher difficulty
+    size_t nJobs = miner.jobs.size();
+    for (int i = 0; i < 32 && miner.jobs.size() == nJobs; i++) {
+        verify_test(miner.submit("1", make_share(dShare0, dBlock)).code == solution_accepted);
+    }
+    verify_test(miner.wait(miner.results.size(), nJobs + 1));
+    verify_test(miner.jobs.back().id == "1" && miner.jobs.back().difficulty == dShare1.m_Packed);
+
+    // the new job is sent at the new difficulty, the job sent before the retarget still accepts easier shares
+    externalPow.new_job("2", input, pow, 101, onBlockFound, []() { return false; });
+    verify_test(miner.wait(miner.results.size(), nJobs + 2));
+    verify_test(miner.jobs.back().id == "2" && miner.jobs.back().difficulty == dShare1.m_Packed);
+    verify_test(miner.submit("2", make_share(dShare0, dShare1)).code == solution_rejected);
+    verify_test(miner.submit("1", make_share(dShare0, dShare1)).code == solution_accepted);
+    verify_test(miner.submit("2", make_share(dShare1, dBlock)).code == solution_accepted);
+
+    // block candidate goes to the node
+    verify_test(miner.submit("2", make_share(dBlock, dNever)).code == solution_accepted);
+    verify_test(nBlocksFound == 1);
+
+    stats = server.get_stats();
+    verify_test(stats.duplicate == 1 && stats.stale == 1 && stats.rejected == 2);
+
+#undef verify_test
+
+    Rules::get().FakePoW = false;
+    return nErrors;
+}
+
 void gen_examples() {
     using namespace beam::stratum;
 
@@ -115,6 +343,8 @@ int main() {
 #endif
     auto logger = Logger::create(logLevel, logLevel);
     auto res = json_creation_test();
+    res += job_template_test();
+    res += server_test();
     gen_examples();
     return res;
 }
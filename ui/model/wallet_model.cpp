@@ -120,9 +120,14 @@ void WalletModel::onChangeCalculated(beam::Amount change)
     emit changeCalculated(change);
 }
 
-void WalletModel::onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos)
+void WalletModel::onUtxoChanged(beam::wallet::ChangeAction action, const std::vector<beam::wallet::Coin>& utxos, uint64_t seq)
 {
-    emit allUtxoChanged(utxos);
+    emit utxoChanged(action, utxos, seq);
+}
+
+void WalletModel::onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos, uint64_t seq)
+{
+    emit allUtxoChanged(utxos, seq);
 }
 
 void WalletModel::onAddresses(bool own, const std::vector<beam::wallet::WalletAddress>& addrs)
@@ -38,7 +38,8 @@ signals:
     void txStatus(beam::wallet::ChangeAction, const std::vector<beam::wallet::TxDescription>& items);
     void syncProgressUpdated(int done, int total);
     void changeCalculated(beam::Amount change);
-    void allUtxoChanged(const std::vector<beam::wallet::Coin>& utxos);
+    void utxoChanged(beam::wallet::ChangeAction, const std::vector<beam::wallet::Coin>& utxos, quint64 seq);
+    void allUtxoChanged(const std::vector<beam::wallet::Coin>& utxos, quint64 seq);
     void addressesChanged(bool own, const std::vector<beam::wallet::WalletAddress>& addresses);
     void generatedNewAddress(const beam::wallet::WalletAddress& walletAddr);
     void newAddressFailed();
@@ -55,7 +56,8 @@ private:
     void onTxStatus(beam::wallet::ChangeAction, const std::vector<beam::wallet::TxDescription>& items) override;
     void onSyncProgressUpdated(int done, int total) override;
     void onChangeCalculated(beam::Amount change) override;
-    void onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos) override;
+    void onUtxoChanged(beam::wallet::ChangeAction, const std::vector<beam::wallet::Coin>& utxos, uint64_t seq) override;
+    void onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos, uint64_t seq) override;
     void onAddresses(bool own, const std::vector<beam::wallet::WalletAddress>& addrs) override;
     void onGeneratedNewAddress(const beam::wallet::WalletAddress& walletAddr) override;
     void onNewAddressFailed() override;
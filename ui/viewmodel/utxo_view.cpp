@@ -42,6 +42,12 @@ UtxoItem::~UtxoItem()
 
 }
 
+void UtxoItem::update(const beam::wallet::Coin& coin)
+{
+    _coin = coin;
+    emit changed();
+}
+
 QString UtxoItem::amount() const
 {
     return BeamToString(_coin.m_ID.m_Value) + " BEAM";
@@ -108,11 +114,15 @@ beam::Height UtxoItem::rawMaturity() const
 
 
 UtxoViewModel::UtxoViewModel()
-    : _model{*AppModel::getInstance().getWallet()}
+    : _utxoSeq(0)
+    , _utxoSynced(false)
+    , _model{*AppModel::getInstance().getWallet()}
     , _sortOrder(Qt::DescendingOrder)
 {
-    connect(&_model, SIGNAL(allUtxoChanged(const std::vector<beam::wallet::Coin>&)),
-        SLOT(onAllUtxoChanged(const std::vector<beam::wallet::Coin>&)));
+    connect(&_model, SIGNAL(utxoChanged(beam::wallet::ChangeAction, const std::vector<beam::wallet::Coin>&, quint64)),
+        SLOT(onUtxoChanged(beam::wallet::ChangeAction, const std::vector<beam::wallet::Coin>&, quint64)));
+    connect(&_model, SIGNAL(allUtxoChanged(const std::vector<beam::wallet::Coin>&, quint64)),
+        SLOT(onAllUtxoChanged(const std::vector<beam::wallet::Coin>&, quint64)));
     connect(&_model, SIGNAL(walletStatus(const beam::wallet::WalletStatus&)), SLOT(onStatus(const beam::wallet::WalletStatus&)));
 
     _model.getAsync()->getUtxosStatus();
@@ -160,8 +170,60 @@ void UtxoViewModel::setSortOrder(Qt::SortOrder value)
     sortUtxos();
 }
 
-void UtxoViewModel::onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos)
+void UtxoViewModel::onUtxoChanged(beam::wallet::ChangeAction action, const std::vector<beam::wallet::Coin>& utxos, quint64 seq)
 {
+    if (!_utxoSynced)
+        return; // the requested snapshot is on its way
+
+    if (seq != _utxoSeq + 1)
+    {
+        // missed some changes, resync
+        _utxoSynced = false;
+        _model.getAsync()->getUtxosStatus();
+        return;
+    }
+
+    if (action == beam::wallet::ChangeAction::Reset)
+    {
+        onAllUtxoChanged(utxos, seq);
+        return;
+    }
+
+    _utxoSeq = seq;
+
+    QList<UtxoItem*> deletedObjects;
+    for (const auto& utxo : utxos)
+    {
+        auto it = find_if(_allUtxos.begin(), _allUtxos.end(), [&utxo](const auto& item) { return item->get_ID() == utxo.m_ID; });
+
+        if (action == beam::wallet::ChangeAction::Removed)
+        {
+            if (it != _allUtxos.end())
+            {
+                deletedObjects.push_back(*it);
+                _allUtxos.erase(it);
+            }
+        }
+        else if (it != _allUtxos.end())
+        {
+            (*it)->update(utxo);
+        }
+        else
+        {
+            _allUtxos.push_back(new UtxoItem(utxo));
+        }
+    }
+
+    sortUtxos();
+
+    qDeleteAll(deletedObjects);
+}
+
+void UtxoViewModel::onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos, quint64 seq)
+{
+    _utxoSeq = seq;
+    _utxoSynced = true;
+
     // TODO: It's dirty hack. Should use QAbstractListModel instead of QQmlListProperty
     auto tmpList = _allUtxos;
     
@@ -33,6 +33,8 @@ public:
     UtxoItem(const beam::wallet::Coin& coin);
     virtual ~UtxoItem();
 
+    void update(const beam::wallet::Coin& coin);
+
     QString amount() const;
     QString maturity() const;
     UtxoViewStatus::EnStatus status() const;
@@ -77,7 +79,8 @@ public:
     Qt::SortOrder sortOrder() const;
     void setSortOrder(Qt::SortOrder);
 public slots:
-    void onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos);
+    void onUtxoChanged(beam::wallet::ChangeAction action, const std::vector<beam::wallet::Coin>& utxos, quint64 seq);
+    void onAllUtxoChanged(const std::vector<beam::wallet::Coin>& utxos, quint64 seq);
     void onStatus(const beam::wallet::WalletStatus& status);
 signals:
     void allUtxoChanged();
@@ -95,6 +98,8 @@ private:
     std::function<bool(const UtxoItem*, const UtxoItem*)> generateComparer();
 
     QList<UtxoItem*> _allUtxos;
+    quint64 _utxoSeq; // of the last applied change
+    bool _utxoSynced; // false until the snapshot arrives
     QString _currentHeight;
     QString _currentStateHash;
     WalletModel& _model;
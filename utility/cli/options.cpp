@@ -36,6 +36,7 @@ namespace beam
         const char* STRATUM_PORT = "stratum_port";
         const char* STRATUM_SECRETS_PATH = "stratum_secrets_path";
         const char* STRATUM_USE_TLS = "stratum_use_tls";
+        const char* STRATUM_SHARE_INTERVAL = "stratum_share_interval";
         const char* STORAGE = "storage";
         const char* WALLET_STORAGE = "wallet_path";
         const char* MINING_THREADS = "mining_threads";
@@ -101,6 +102,7 @@ namespace beam
         const char* LOG_DEBUG = "debug";
         const char* LOG_VERBOSE = "verbose";
         const char* LOG_CLEANUP_DAYS = "log_cleanup_days";
+        const char* LOG_ASYNC_BUFFER = "log_async_buffer";
         const char* LOG_UTXOS = "log_utxos";
         const char* VERSION = "version";
         const char* VERSION_FULL = "version,v";
@@ -191,10 +193,12 @@ namespace beam
             (cli::STRATUM_PORT, po::value<uint16_t>()->default_value(0), "port to start stratum server on")
             (cli::STRATUM_SECRETS_PATH, po::value<string>()->default_value("."), "path to stratum server api keys file, and tls certificate and private key")
             (cli::STRATUM_USE_TLS, po::value<bool>()->default_value(true), "enable TLS on startum server")
+            (cli::STRATUM_SHARE_INTERVAL, po::value<unsigned>()->default_value(0), "target seconds between shares of a stratum miner, share difficulty is adjusted per miner (0 = solutions at block difficulty only)")
             (cli::RESYNC, po::value<bool>()->default_value(false), "Enforce re-synchronization (soft reset)")
             (cli::RESET_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication). Must do if the node is cloned")
             (cli::ERASE_ID, po::value<bool>()->default_value(false), "Reset self ID (used for network authentication) and stop before re-creating the new one.")
             (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check and compact (vacuum)")
+            (cli::LOG_ASYNC_BUFFER, po::value<uint32_t>()->default_value(0), "per-thread async log buffer size in KB, messages are written by a background thread (0 = synchronous logging)")
             (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
             (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
             (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
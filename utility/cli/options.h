@@ -31,6 +31,7 @@ namespace beam
         extern const char* STRATUM_PORT;
         extern const char* STRATUM_SECRETS_PATH;
         extern const char* STRATUM_USE_TLS;
+        extern const char* STRATUM_SHARE_INTERVAL;
         extern const char* STORAGE;
         extern const char* WALLET_STORAGE;
         extern const char* MINING_THREADS;
@@ -98,6 +99,7 @@ namespace beam
         extern const char* LOG_DEBUG;
         extern const char* LOG_VERBOSE;
         extern const char* LOG_CLEANUP_DAYS;
+        extern const char* LOG_ASYNC_BUFFER;
         extern const char* LOG_UTXOS;
         extern const char* VERSION;
         extern const char* VERSION_FULL;
@@ -34,6 +34,11 @@
 #include <iostream>
 #include <fstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include <algorithm>
 
 namespace beam {
@@ -43,11 +48,10 @@ using namespace std;
 Logger* Logger::g_logger = 0;
 
 class LoggerImpl : public Logger {
-    mutex _mutex;
 protected:
-    static const size_t MAX_HEADER_SIZE = 256;
     static const size_t MAX_TIMESTAMP_SIZE = 80;
 
+    mutex _mutex;
     FILE* _sink;
     int _minLevel;
     int _flushLevel;
@@ -66,12 +70,14 @@ protected:
         if (minLevel <= 0) throw runtime_error("logger: minimal level out of range");
     }
 
+public:
     virtual ~LoggerImpl() {
         if (this == g_logger) {
             g_logger = 0;
         }
     }
 
+protected:
     void set_header_formatter(LogMessageHeaderFormatter formatter) override {
         if (formatter) _headerFormatter = formatter;
     }
@@ -87,15 +93,9 @@ protected:
     }
 
     void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
-        char timestampFormatted[MAX_TIMESTAMP_SIZE];
         char headerFormatted[MAX_HEADER_SIZE];
-        if (!_timeFormat.empty()) {
-            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
-        } else {
-            timestampFormatted[0] = 0;
-        }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
-        write_impl(header.level, headerFormatted, headerSize, buf, size);
+        size_t headerSize = format_header(header, headerFormatted);
+        write_formatted(header.level, headerFormatted, headerSize, buf, size);
     }
 
     const FileNameType& get_current_file_name() override {
@@ -104,13 +104,32 @@ protected:
     }
 
 public:
+    static const size_t MAX_HEADER_SIZE = 256;
+
     bool level_accepted(int level) override {
         return level >= _minLevel;
     }
 
+    /// Formats header into buf (of MAX_HEADER_SIZE bytes), returns header size
+    size_t format_header(const LogMessageHeader& header, char* buf) {
+        char timestampFormatted[MAX_TIMESTAMP_SIZE];
+        if (!_timeFormat.empty()) {
+            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
+        } else {
+            timestampFormatted[0] = 0;
+        }
+        size_t headerSize = _headerFormatter(buf, MAX_HEADER_SIZE, timestampFormatted, header);
+        return std::min(headerSize, MAX_HEADER_SIZE - 1);
+    }
+
+    /// Writes already formatted message to the sink(s) accepting its level
+    virtual void write_formatted(int level, const char* header, size_t headerSize, const char* msg, size_t size) {
+        write_impl(level, header, headerSize, msg, size);
+    }
+
     void write_impl(int level, const char* header, size_t headerSize, const char* msg, size_t size) {
-        if (!_sink) return;
         lock_guard<mutex> lock(_mutex);
+        if (!_sink) return;
         fwrite(header, 1, headerSize, _sink);
         fwrite(msg, 1, size, _sink);
         if (level >= _flushLevel) fflush(_sink);
@@ -139,6 +158,8 @@ public:
 
     void rotate() override {
         try {
+            // the sink may be in use by other threads (or by the async writer)
+            lock_guard<mutex> lock(_mutex);
             open_new_file();
         } catch (const std::exception& e) {
             fprintf(stderr, "log error, %s\n", e.what());
@@ -146,7 +167,7 @@ public:
     }
 
     ~FileLogger() {
-        fclose(_sink);
+        if (_sink) fclose(_sink);
     }
 
     const FileNameType& get_current_file_name() override {
@@ -223,20 +244,12 @@ public:
         _consoleSink(flushLevel, consoleLevel)
     {}
 
-    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
-        char timestampFormatted[MAX_TIMESTAMP_SIZE];
-        char headerFormatted[MAX_HEADER_SIZE];
-        if (!_timeFormat.empty()) {
-            format_timestamp(timestampFormatted, MAX_TIMESTAMP_SIZE, _timeFormat.c_str(), header.timestamp, _printMilliseconds);
-        } else {
-            timestampFormatted[0] = 0;
-        }
-        size_t headerSize = _headerFormatter(headerFormatted, MAX_HEADER_SIZE, timestampFormatted, header);
-        if (_consoleSink.level_accepted(header.level)) {
-            _consoleSink.write_impl(header.level, headerFormatted, headerSize, buf, size);
+    void write_formatted(int level, const char* header, size_t headerSize, const char* msg, size_t size) override {
+        if (_consoleSink.level_accepted(level)) {
+            _consoleSink.write_impl(level, header, headerSize, msg, size);
         }
-        if (_fileSink.level_accepted(header.level)) {
-            _fileSink.write_impl(header.level, headerFormatted, headerSize, buf, size);
+        if (_fileSink.level_accepted(level)) {
+            _fileSink.write_impl(level, header, headerSize, msg, size);
         }
     }
 
@@ -249,18 +262,246 @@ public:
     }
 };
 
+// Formats messages on the calling thread and puts them into the thread's own ring buffer
+// (single producer/single consumer, no locks on the hot path). A background thread drains
+// all the rings in batches and writes them to the underlying sinks.
+// If a ring is full the message is dropped, the writer reports the number of dropped messages.
+class AsyncLogger : public Logger {
+
+    struct RecordHeader {
+        uint32_t size; // header + message, 0 means the rest of the buffer is skipped
+        uint32_t headerSize;
+        int level;
+    };
+
+    struct Ring {
+        explicit Ring(size_t capacity) : data(capacity) {}
+
+        std::vector<char> data;
+        std::atomic<size_t> head{0}; // advanced by the producer
+        std::atomic<size_t> tail{0}; // advanced by the writer
+        std::atomic<bool> orphaned{false}; // producer thread exited
+
+        bool push(int level, const char* header, size_t headerSize, const char* msg, size_t size) {
+            const size_t capacity = data.size();
+            const size_t need = sizeof(RecordHeader) + headerSize + size;
+            if (need > capacity) return false;
+
+            size_t h = head.load(memory_order_relaxed);
+            size_t t = tail.load(memory_order_acquire);
+
+            size_t offset = h % capacity;
+            size_t remaining = capacity - offset;
+            size_t skip = (remaining < need) ? remaining : 0;
+
+            if (h + skip + need - t > capacity) return false;
+
+            if (skip) {
+                if (remaining >= sizeof(RecordHeader)) {
+                    RecordHeader rh = { 0, 0, 0 };
+                    memcpy(&data[offset], &rh, sizeof(rh));
+                }
+                offset = 0;
+            }
+
+            RecordHeader rh = { uint32_t(headerSize + size), uint32_t(headerSize), level };
+            char* p = &data[offset];
+            memcpy(p, &rh, sizeof(rh));
+            memcpy(p + sizeof(rh), header, headerSize);
+            memcpy(p + sizeof(rh) + headerSize, msg, size);
+
+            head.store(h + skip + need, memory_order_release);
+            return true;
+        }
+
+        // returns true if the ring was not empty
+        bool drain(LoggerImpl& sink) {
+            const size_t capacity = data.size();
+            size_t t = tail.load(memory_order_relaxed);
+            size_t h = head.load(memory_order_acquire);
+            if (t == h) return false;
+
+            while (t != h) {
+                size_t offset = t % capacity;
+                size_t remaining = capacity - offset;
+                if (remaining < sizeof(RecordHeader)) {
+                    t += remaining;
+                    continue;
+                }
+                RecordHeader rh;
+                memcpy(&rh, &data[offset], sizeof(rh));
+                if (!rh.size) {
+                    t += remaining;
+                    continue;
+                }
+                const char* p = &data[offset] + sizeof(rh);
+                sink.write_formatted(rh.level, p, rh.headerSize, p + rh.headerSize, rh.size - rh.headerSize);
+                t += sizeof(rh) + rh.size;
+            }
+
+            tail.store(t, memory_order_release);
+            return true;
+        }
+    };
+
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring;
+        uint64_t generation = 0;
+
+        ~ThreadRing() {
+            if (ring) ring->orphaned = true;
+        }
+    };
+
+    static constexpr unsigned IDLE_TIMEOUT_MSEC = 50;
+
+    std::unique_ptr<LoggerImpl> _impl;
+    const size_t _ringSize;
+    const int _flushLevel;
+    const uint64_t _generation;
+
+    mutex _ringsMutex;
+    std::vector<std::shared_ptr<Ring>> _rings;
+
+    mutex _wakeupMutex;
+    condition_variable _wakeup;
+    std::atomic<bool> _stop{false};
+    std::atomic<uint64_t> _dropped{0};
+    std::thread _writer;
+
+    static uint64_t next_generation() {
+        static std::atomic<uint64_t> s_generation{0};
+        return ++s_generation;
+    }
+
+    // LoggerImpl hides the Logger interface methods
+    Logger& sinks() {
+        return *_impl;
+    }
+
+    Ring& get_thread_ring() {
+        static thread_local ThreadRing t;
+        if (t.generation != _generation) {
+            // first message from this thread, or the ring belongs to a previous logger instance
+            t.ring = std::make_shared<Ring>(_ringSize);
+            t.generation = _generation;
+            lock_guard<mutex> lock(_ringsMutex);
+            _rings.push_back(t.ring);
+        }
+        return *t.ring;
+    }
+
+    void report_dropped() {
+        uint64_t dropped = _dropped.exchange(0);
+        if (!dropped) return;
+
+        LogMessageHeader header(LOG_LEVEL_WARNING, 0, 0, 0);
+        char headerFormatted[LoggerImpl::MAX_HEADER_SIZE];
+        size_t headerSize = _impl->format_header(header, headerFormatted);
+
+        char msg[80];
+        int size = snprintf(msg, sizeof(msg), "logger: %llu message(s) dropped, async buffer overflow\n", (unsigned long long) dropped);
+        _impl->write_formatted(header.level, headerFormatted, headerSize, msg, size);
+    }
+
+    void thread_func() {
+        std::vector<std::shared_ptr<Ring>> rings;
+        while (true) {
+            bool stop = _stop.load(memory_order_acquire);
+            {
+                lock_guard<mutex> lock(_ringsMutex);
+                // rings of exited threads are removed once drained
+                _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<Ring>& r) {
+                    return r->orphaned && (r->head.load(memory_order_acquire) == r->tail.load(memory_order_relaxed));
+                }), _rings.end());
+                rings = _rings;
+            }
+
+            bool written = false;
+            for (const auto& r : rings) {
+                if (r->drain(*_impl)) written = true;
+            }
+            report_dropped();
+
+            if (written) continue;
+            if (stop) break;
+
+            unique_lock<mutex> lock(_wakeupMutex);
+            _wakeup.wait_for(lock, chrono::milliseconds(IDLE_TIMEOUT_MSEC));
+        }
+    }
+
+public:
+    AsyncLogger(std::unique_ptr<LoggerImpl>&& impl, size_t ringSize, int flushLevel) :
+        _impl(std::move(impl)),
+        _ringSize(ringSize),
+        _flushLevel(flushLevel),
+        _generation(next_generation())
+    {
+        if (_ringSize < LoggerImpl::MAX_HEADER_SIZE * 4) throw runtime_error("logger: async buffer size too small");
+        _writer = std::thread(&AsyncLogger::thread_func, this);
+    }
+
+    ~AsyncLogger() {
+        if (this == g_logger) {
+            g_logger = 0;
+        }
+        _stop = true;
+        _wakeup.notify_one();
+        _writer.join();
+    }
+
+    void set_header_formatter(LogMessageHeaderFormatter formatter) override {
+        sinks().set_header_formatter(formatter);
+    }
+
+    void set_time_format(const char* format, bool printMilliseconds) override {
+        sinks().set_time_format(format, printMilliseconds);
+    }
+
+    const FileNameType& get_current_file_name() override {
+        return sinks().get_current_file_name();
+    }
+
+    void rotate() override {
+        sinks().rotate();
+    }
+
+protected:
+    bool level_accepted(int level) override {
+        return _impl->level_accepted(level);
+    }
+
+    void write_message(const LogMessageHeader& header, const char* buf, size_t size) override {
+        char headerFormatted[LoggerImpl::MAX_HEADER_SIZE];
+        size_t headerSize = _impl->format_header(header, headerFormatted);
+
+        Ring& ring = get_thread_ring();
+        if (!ring.push(header.level, headerFormatted, headerSize, buf, size)) {
+            _dropped.fetch_add(1, memory_order_relaxed);
+            _wakeup.notify_one();
+            return;
+        }
+
+        if (header.level >= _flushLevel) {
+            _wakeup.notify_one();
+        }
+    }
+};
+
 std::shared_ptr<Logger> Logger::create(
     int flushLevel,
     int consoleLevel,
     int fileLevel,
     const std::string& fileNamePrefix,
-    const std::string& dstPath
+    const std::string& dstPath,
+    size_t asyncBufferSize
 ) {
     if (g_logger) {
         throw runtime_error("logger already initialized");
     }
 
-    std::shared_ptr<Logger> logger;
+    std::unique_ptr<LoggerImpl> impl;
 
     int what = 0;
 
@@ -269,18 +510,25 @@ std::shared_ptr<Logger> Logger::create(
 
     switch (what) {
         case 3:
-            logger.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath));
+            impl.reset(new CombinedLogger(flushLevel, consoleLevel, fileLevel, fileNamePrefix, dstPath));
             break;
         case 2:
-            logger.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath));
+            impl.reset(new FileLogger(flushLevel, fileLevel, fileNamePrefix, dstPath));
             break;
         case 1:
-            logger.reset(new ConsoleLogger(flushLevel, consoleLevel));
+            impl.reset(new ConsoleLogger(flushLevel, consoleLevel));
             break;
         default:
             throw runtime_error("no logger sink configured");
     }
 
+    std::shared_ptr<Logger> logger;
+    if (asyncBufferSize) {
+        logger = std::make_shared<AsyncLogger>(std::move(impl), asyncBufferSize, flushLevel);
+    } else {
+        logger = std::move(impl);
+    }
+
     g_logger = logger.get();
     return logger;
 }
@@ -144,7 +144,11 @@ public:
         const std::string& fileNamePrefix = std::string(),
 
         // path to log file
-        const std::string& dstPath = std::string()
+        const std::string& dstPath = std::string(),
+
+        // per-thread buffer size in bytes for asynchronous logging: messages are written
+        // by a background thread and dropped if the buffer overflows. 0 means synchronous logging
+        size_t asyncBufferSize = 0
     );
 
     virtual ~Logger() {}
@@ -15,6 +15,10 @@
 #include "utility/logger_checkpoints.h"
 #include "utility/helpers.h"
 #include <thread>
+#include <vector>
+#include <fstream>
+#include <regex>
+#include <boost/filesystem.hpp>
 #include "wallet/secstring.h"
 
 using namespace beam;
@@ -80,6 +84,70 @@ void test_ndc_2(bool exc)
     }
 }
 
+// Several threads log through tiny rings into a file, every line must be either a whole message or a drop report
+bool test_async_logger() {
+    static const char* dir = "logger_test_async";
+    static const int nThreads = 4;
+    static const int nMessages = 2000;
+
+    boost::filesystem::remove_all(dir);
+
+    std::string path;
+    {
+        auto logger = Logger::create(LOG_LEVEL_WARNING, LOG_SINK_DISABLED, LOG_LEVEL_DEBUG, "async_", dir, 1024);
+        logger->set_header_formatter(custom_header_formatter);
+        path = logger->get_current_file_name();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nThreads; i++) {
+            threads.emplace_back([i]() {
+                for (int j = 0; j < nMessages; j++) {
+                    LOG_INFO() << "T" << i << " M" << j << " " << std::string(j % 40, 'x') << " END";
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    } // the writer drains everything on destruction
+
+    std::ifstream file(path);
+    std::regex reMsg("^I \\S+ T(\\d+) M(\\d+) (x*) END$");
+    std::regex reDropped("^W \\S+ logger: (\\d+) message\\(s\\) dropped, async buffer overflow$");
+
+    int lastMsg[nThreads];
+    std::fill_n(lastMsg, nThreads, -1);
+    uint64_t delivered = 0, dropped = 0;
+    bool ok = true;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::smatch m;
+        if (std::regex_match(line, m, reMsg)) {
+            int i = std::stoi(m[1]);
+            int j = std::stoi(m[2]);
+            // each thread's messages come in order, the payload is intact
+            if (i >= nThreads || j <= lastMsg[i] || m[3].length() != size_t(j % 40)) {
+                ok = false;
+                break;
+            }
+            lastMsg[i] = j;
+            delivered++;
+        } else if (std::regex_match(line, m, reDropped)) {
+            dropped += std::stoull(m[1]);
+        } else {
+            std::cout << "torn line: " << line << '\n';
+            ok = false;
+            break;
+        }
+    }
+    file.close();
+    boost::filesystem::remove_all(dir);
+
+    std::cout << "async logger: delivered " << delivered << ", dropped " << dropped << '\n';
+    return ok && (delivered + dropped == uint64_t(nThreads) * nMessages);
+}
+
 void test_read_password() {
     SecString buf;
     read_password("Enter seed: ", buf);
@@ -97,5 +165,9 @@ int main() {
         test_ndc_2(true);
     }
     catch(...) {}
+    if (!test_async_logger()) {
+        std::cout << "async logger test failed\n";
+        return 1;
+    }
 #endif
 }
@@ -423,6 +423,27 @@ namespace beam::wallet
         _handler.onMessage(id, walletStatus);
     }
 
+    void WalletApi::onSubscribeMessage(int id, const nlohmann::json& params)
+    {
+        Subscribe subscribe;
+
+        static const char* Names[] = { "system_state", "txs", "utxos" };
+        bool* values[] = { &subscribe.systemState, &subscribe.txs, &subscribe.utxos };
+
+        for (size_t i = 0; i < _countof(Names); i++)
+        {
+            if (existsJsonParam(params, Names[i]))
+            {
+                if (!params[Names[i]].is_boolean())
+                    throw jsonrpc_exception{ INVALID_PARAMS_JSON_RPC , std::string("Invalid '") + Names[i] + "' parameter.", id };
+
+                *values[i] = params[Names[i]];
+            }
+        }
+
+        _handler.onMessage(id, subscribe);
+    }
+
     void WalletApi::getResponse(int id, const CreateAddress::Response& res, json& msg)
     {
         msg = json
@@ -492,6 +513,25 @@ namespace beam::wallet
         };
     }
 
+    static void getUtxoJson(const Coin& utxo, json& msg)
+    {
+        std::string createTxId = utxo.m_createTxId.is_initialized() ? txIDToString(*utxo.m_createTxId) : "";
+        std::string spentTxId = utxo.m_spentTxId.is_initialized() ? txIDToString(*utxo.m_spentTxId) : "";
+
+        msg = json
+        {
+            {"id", utxo.toStringID()},
+            {"amount", utxo.m_ID.m_Value},
+            {"type", (const char*)FourCC::Text(utxo.m_ID.m_Type)},
+            {"maturity", utxo.get_Maturity()},
+            {"createTxId", createTxId},
+            {"spentTxId", spentTxId},
+            {"status", utxo.m_status},
+            {"status_string", utxo.getStatusString()},
+            {"session", utxo.m_sessionId}
+        };
+    }
+
     void WalletApi::getResponse(int id, const GetUtxo::Response& res, json& msg)
     {
         msg = json
@@ -503,21 +543,9 @@ namespace beam::wallet
 
         for (auto& utxo : res.utxos)
         {
-            std::string createTxId = utxo.m_createTxId.is_initialized() ? txIDToString(*utxo.m_createTxId) : "";
-            std::string spentTxId = utxo.m_spentTxId.is_initialized() ? txIDToString(*utxo.m_spentTxId) : "";
-
-            msg["result"].push_back(
-            { 
-                {"id", utxo.toStringID()},
-                {"amount", utxo.m_ID.m_Value},
-                {"type", (const char*)FourCC::Text(utxo.m_ID.m_Type)},
-                {"maturity", utxo.get_Maturity()},
-                {"createTxId", createTxId},
-                {"spentTxId", spentTxId},
-                {"status", utxo.m_status},
-                {"status_string", utxo.getStatusString()},
-                {"session", utxo.m_sessionId}
-            });
+            json item = {};
+            getUtxoJson(utxo, item);
+            msg["result"].push_back(item);
         }
     }
 
@@ -675,6 +703,88 @@ namespace beam::wallet
         };
     }
 
+    void WalletApi::getResponse(int id, const Subscribe::Response& res, json& msg)
+    {
+        msg = json
+        {
+            {"jsonrpc", "2.0"},
+            {"id", id},
+            {"result", res.result}
+        };
+    }
+
+    void WalletApi::getNotification(const SystemStateChanged& data, json& msg)
+    {
+        msg = json
+        {
+            {"jsonrpc", "2.0"},
+            {"method", "ev_system_state"},
+            {"params",
+                {
+                    {"current_height", data.stateID.m_Height},
+                    {"current_state_hash", to_hex(data.stateID.m_Hash.m_pData, data.stateID.m_Hash.nBytes)},
+                }
+            }
+        };
+    }
+
+    void WalletApi::getNotification(const TxsChanged& data, json& msg)
+    {
+        msg = json
+        {
+            {"jsonrpc", "2.0"},
+            {"method", "ev_txs_changed"},
+            {"params",
+                {
+                    {"txs", json::array()},
+                    {"removed", json::array()},
+                }
+            }
+        };
+
+        for (const auto& resItem : data.txs)
+        {
+            json item = {};
+            getStatusResponseJson(resItem.tx, item, resItem.kernelProofHeight, resItem.systemHeight);
+            msg["params"]["txs"].push_back(item);
+        }
+
+        for (const auto& txId : data.removed)
+        {
+            msg["params"]["removed"].push_back(txIDToString(txId));
+        }
+    }
+
+    void WalletApi::getNotification(const UtxosChanged& data, json& msg)
+    {
+        msg = json
+        {
+            {"jsonrpc", "2.0"},
+            {"method", "ev_utxos_changed"},
+            {"params",
+                {
+                    {"reset", data.reset},
+                    {"utxos", json::array()},
+                    {"removed", json::array()},
+                }
+            }
+        };
+
+        for (const auto& utxo : data.utxos)
+        {
+            json item = {};
+            getUtxoJson(utxo, item);
+            msg["params"]["utxos"].push_back(item);
+        }
+
+        for (const auto& cid : data.removed)
+        {
+            Coin utxo;
+            utxo.m_ID = cid;
+            msg["params"]["removed"].push_back(utxo.toStringID());
+        }
+    }
+
     bool WalletApi::parse(const char* data, size_t size)
     {
         if (size == 0)
@@ -694,9 +804,62 @@ namespace beam::wallet
             return false;
         }
 
+        json root;
+
+        try
+        {
+            root = json::parse(data, data + size);
+        }
+        catch (const std::exception& e)
+        {
+            json msg
+            {
+                {"jsonrpc", "2.0"},
+                {"error",
+                    {
+                        {"code", INTERNAL_JSON_RPC_ERROR},
+                        {"message", e.what()},
+                    }
+                }
+            };
+
+            _handler.onInvalidJsonRpc(msg);
+            return true;
+        }
+
+        if (root.is_array())
+        {
+            // JSON-RPC 2.0 batch, an empty array is a single invalid request
+            if (root.empty())
+            {
+                parseJsonRpc(json::object(), data, size);
+                return true;
+            }
+
+            _handler.onBatchBegin();
+
+            for (const auto& item : root)
+            {
+                parseJsonRpc(item, data, size);
+            }
+
+            _handler.onBatchEnd();
+        }
+        else
+        {
+            parseJsonRpc(root, data, size);
+        }
+
+        return true;
+    }
+
+    void WalletApi::parseJsonRpc(const json& request, const char* data, size_t size)
+    {
         try
         {
-            json msg = json::parse(data, data + size);
+            if (!request.is_object()) throwInvalidJsonRpc();
+
+            json msg = request;
 
             if (msg["jsonrpc"] != "2.0") throwInvalidJsonRpc();
             if (msg["id"] <= 0) throwInvalidJsonRpc();
@@ -761,7 +924,5 @@ namespace beam::wallet
 
             _handler.onInvalidJsonRpc(msg);
         }
-
-        return true;
     }
 }
@@ -51,7 +51,8 @@ namespace beam::wallet
     macro(Lock,             "lock",             API_WRITE_ACCESS)   \
     macro(Unlock,           "unlock",           API_WRITE_ACCESS)   \
     macro(TxList,           "tx_list",          API_READ_ACCESS)    \
-    macro(WalletStatus,     "wallet_status",    API_READ_ACCESS)
+    macro(WalletStatus,     "wallet_status",    API_READ_ACCESS)    \
+    macro(Subscribe,        "ev_subscribe",     API_READ_ACCESS)
 
     struct AddressData
     {
@@ -230,11 +231,47 @@ namespace beam::wallet
         };
     };
 
+    struct Subscribe
+    {
+        bool systemState = false;
+        bool txs = false;
+        bool utxos = false;
+
+        struct Response
+        {
+            bool result;
+        };
+    };
+
+    // push notifications, sent without request id to the subscribed connections
+
+    struct SystemStateChanged
+    {
+        Block::SystemState::ID stateID;
+    };
+
+    struct TxsChanged
+    {
+        std::vector<Status::Response> txs;
+        std::vector<wallet::TxID> removed;
+    };
+
+    struct UtxosChanged
+    {
+        bool reset = false; // the whole set was replaced, utxos is the new one
+        std::vector<Coin> utxos; // added or updated
+        std::vector<Coin::ID> removed;
+    };
+
     class IWalletApiHandler
     {
     public:
         virtual void onInvalidJsonRpc(const json& msg) = 0;
 
+        // JSON-RPC 2.0 batch, all the responses between these calls belong to one reply
+        virtual void onBatchBegin() {}
+        virtual void onBatchEnd() {}
+
 #define MESSAGE_FUNC(api, name, _) \
         virtual void onMessage(int id, const api& data) = 0;
 
@@ -259,10 +296,16 @@ namespace beam::wallet
 
 #undef RESPONSE_FUNC
 
+        void getNotification(const SystemStateChanged& data, json& msg);
+        void getNotification(const TxsChanged& data, json& msg);
+        void getNotification(const UtxosChanged& data, json& msg);
+
         bool parse(const char* data, size_t size);
 
     private:
 
+        void parseJsonRpc(const json& msg, const char* data, size_t size);
+
 #define MESSAGE_FUNC(api, name, _) \
         void on##api##Message(int id, const json& msg);
 
@@ -21,6 +21,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <map>
+#include <set>
 
 #include "utility/cli/options.h"
 #include "utility/helpers.h"
@@ -49,6 +50,7 @@ using json = nlohmann::json;
 
 static const unsigned LOG_ROTATION_PERIOD = 3 * 60 * 60 * 1000; // 3 hours
 static const size_t PACKER_FRAGMENTS_SIZE = 4096;
+static const unsigned PUSH_COALESCE_PERIOD = 100; // ms
 
 using namespace beam;
 using namespace beam::wallet;
@@ -244,7 +246,36 @@ namespace
             {
                 json msg;
                 _api.getResponse(id, response, msg);
-                serializeMsg(msg);
+                sendMsg(msg);
+            }
+
+            void sendMsg(const json& msg)
+            {
+                if (_batch)
+                {
+                    _batch->push_back(msg);
+                }
+                else
+                {
+                    serializeMsg(msg);
+                }
+            }
+
+            void onBatchBegin() override
+            {
+                _batch = json::array();
+            }
+
+            void onBatchEnd() override
+            {
+                // the whole batch goes out as one array in one write
+                json batch = std::move(*_batch);
+                _batch.reset();
+
+                if (!batch.empty())
+                {
+                    serializeMsg(batch);
+                }
             }
 
             void doError(int id, int code, const std::string& info)
@@ -261,14 +292,14 @@ namespace
                     }
                 };
 
-                serializeMsg(msg);
+                sendMsg(msg);
             }
 
             void onInvalidJsonRpc(const json& msg) override
             {
                 LOG_DEBUG() << "onInvalidJsonRpc: " << msg;
 
-                serializeMsg(msg);
+                sendMsg(msg);
             }
 
             void FillAddressData(const AddressData& data, WalletAddress& address)
@@ -612,6 +643,99 @@ namespace
                 doResponse(id, response);
             }
 
+            void onMessage(int id, const Subscribe& data) override
+            {
+                LOG_DEBUG() << "Subscribe(id = " << id << " system_state = " << data.systemState << " txs = " << data.txs << " utxos = " << data.utxos << ")";
+
+                if (!canPush())
+                {
+                    doError(id, NOTFOUND_JSON_RPC, "Subscriptions are not supported over HTTP.");
+                    return;
+                }
+
+                _subscription = data;
+
+                if (!_subscription.txs)
+                {
+                    _changedTxs.clear();
+                    _removedTxs.clear();
+                }
+
+                if (!_subscription.utxos)
+                {
+                    _utxosReset = false;
+                    _changedUtxos.clear();
+                    _removedUtxos.clear();
+                }
+
+                if (!_subscription.systemState)
+                {
+                    _systemStateChanged = false;
+                }
+
+                doResponse(id, Subscribe::Response{ true });
+            }
+
+            void onCoinsChanged(ChangeAction action, const std::vector<Coin>& items) override
+            {
+                if (!_subscription.utxos)
+                    return;
+
+                if (action == ChangeAction::Reset)
+                {
+                    _utxosReset = true;
+                    _changedUtxos.clear();
+                    _removedUtxos.clear();
+                }
+
+                for (const auto& coin : items)
+                {
+                    if (action == ChangeAction::Removed)
+                    {
+                        _changedUtxos.erase(coin.m_ID);
+                        _removedUtxos.insert(coin.m_ID);
+                    }
+                    else
+                    {
+                        _removedUtxos.erase(coin.m_ID);
+                        _changedUtxos[coin.m_ID] = coin;
+                    }
+                }
+
+                schedulePush();
+            }
+
+            void onTransactionChanged(ChangeAction action, std::vector<TxDescription>&& items) override
+            {
+                if (!_subscription.txs)
+                    return;
+
+                for (const auto& tx : items)
+                {
+                    if (action == ChangeAction::Removed)
+                    {
+                        _changedTxs.erase(tx.m_txId);
+                        _removedTxs.insert(tx.m_txId);
+                    }
+                    else
+                    {
+                        _removedTxs.erase(tx.m_txId);
+                        _changedTxs.insert(tx.m_txId);
+                    }
+                }
+
+                schedulePush();
+            }
+
+            void onSystemStateChanged() override
+            {
+                if (_subscription.systemState)
+                {
+                    _systemStateChanged = true;
+                    schedulePush();
+                }
+            }
+
             void onMessage(int id, const Lock& data) override
             {
                 LOG_DEBUG() << "Lock(id = " << id << ")";
@@ -696,11 +820,109 @@ namespace
                 doError(id, NOTFOUND_JSON_RPC, "Method not implemented yet.");
             }
 
+            virtual bool canPush() const
+            {
+                return false;
+            }
+
+            // changes are accumulated for a short period and pushed as one event per kind
+            void schedulePush()
+            {
+                if (_pushPending)
+                    return;
+
+                if (!_pushTimer)
+                {
+                    _pushTimer = io::Timer::create(io::Reactor::get_Current());
+                }
+
+                _pushPending = true;
+                _pushTimer->start(PUSH_COALESCE_PERIOD, false, BIND_THIS_MEMFN(onPushTimer));
+            }
+
+            void onPushTimer()
+            {
+                _pushPending = false;
+
+                Block::SystemState::ID stateID = {};
+                _walletDB->getSystemStateID(stateID);
+
+                if (_systemStateChanged)
+                {
+                    _systemStateChanged = false;
+
+                    json msg;
+                    _api.getNotification(SystemStateChanged{ stateID }, msg);
+                    sendMsg(msg);
+                }
+
+                if (!_changedTxs.empty() || !_removedTxs.empty())
+                {
+                    TxsChanged data;
+
+                    for (const auto& txId : _changedTxs)
+                    {
+                        auto tx = _walletDB->getTx(txId);
+                        if (!tx)
+                            continue;
+
+                        Status::Response item;
+                        item.tx = *tx;
+                        item.kernelProofHeight = 0;
+                        item.systemHeight = stateID.m_Height;
+                        item.confirmations = 0;
+
+                        storage::getTxParameter(*_walletDB, tx->m_txId, TxParameterID::KernelProofHeight, item.kernelProofHeight);
+                        data.txs.push_back(item);
+                    }
+
+                    data.removed.assign(_removedTxs.begin(), _removedTxs.end());
+
+                    _changedTxs.clear();
+                    _removedTxs.clear();
+
+                    json msg;
+                    _api.getNotification(data, msg);
+                    sendMsg(msg);
+                }
+
+                if (_utxosReset || !_changedUtxos.empty() || !_removedUtxos.empty())
+                {
+                    UtxosChanged data;
+                    data.reset = _utxosReset;
+
+                    data.utxos.reserve(_changedUtxos.size());
+                    for (const auto& it : _changedUtxos)
+                        data.utxos.push_back(it.second);
+
+                    data.removed.assign(_removedUtxos.begin(), _removedUtxos.end());
+
+                    _utxosReset = false;
+                    _changedUtxos.clear();
+                    _removedUtxos.clear();
+
+                    json msg;
+                    _api.getNotification(data, msg);
+                    sendMsg(msg);
+                }
+            }
+
         protected:
             IWalletDB::Ptr _walletDB;
             Wallet& _wallet;
             WalletApi _api;
             IWalletMessageEndpoint& _wnet;
+            boost::optional<json> _batch;
+
+            Subscribe _subscription;
+            io::Timer::Ptr _pushTimer;
+            bool _pushPending = false;
+            bool _systemStateChanged = false;
+            bool _utxosReset = false;
+            std::map<Coin::ID, Coin> _changedUtxos;
+            std::set<Coin::ID> _removedUtxos;
+            std::set<TxID> _changedTxs;
+            std::set<TxID> _removedTxs;
         };
 
         class TcpApiConnection : public ApiConnection
@@ -726,9 +948,21 @@ namespace
                 serialize_json_msg(_lineProtocol, msg);
             }
 
+            bool canPush() const override
+            {
+                return true;
+            }
+
             void on_write(io::SharedBuffer&& msg)
             {
-                _stream->write(msg);
+                if (_pipelining)
+                {
+                    _pending.push_back(std::move(msg));
+                }
+                else
+                {
+                    _stream->write(msg);
+                }
             }
 
             bool on_raw_message(void* data, size_t size)
@@ -747,7 +981,18 @@ namespace
                     return false;
                 }
 
-                if (!_lineProtocol.new_data_from_stream(data, size))
+                // all the requests pipelined in this chunk are answered with a single write
+                _pipelining = true;
+                bool ok = _lineProtocol.new_data_from_stream(data, size);
+                _pipelining = false;
+
+                if (!_pending.empty())
+                {
+                    _stream->write(_pending);
+                    _pending.clear();
+                }
+
+                if (!ok)
                 {
                     LOG_INFO() << "stream corrupted";
                     _server.closeConnection(_stream->peer_address().u64());
@@ -761,6 +1006,8 @@ namespace
             io::TcpStream::Ptr _stream;
             LineProtocol _lineProtocol;
             IWalletApiServer& _server;
+            bool _pipelining = false;
+            io::SerializedMsg _pending;
         };
 
         class HttpApiConnection : public ApiConnection
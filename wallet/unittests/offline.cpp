@@ -23,7 +23,7 @@
 namespace beam {
     using namespace wallet;
 struct WalletDBObserver : IWalletDbObserver {
-    void onCoinsChanged() {
+    void onCoinsChanged(ChangeAction, const std::vector<Coin>&) {
         LOG_DEBUG() << _who << " " << __FUNCTION__;
     }
     void onTransactionChanged(ChangeAction, std::vector<TxDescription>&& )  {
@@ -456,6 +456,122 @@ namespace
             WALLET_CHECK(res["result"]["is_valid"] == valid);
         }
     }
+
+    void testSubscribeJsonRpc(const std::string& msg)
+    {
+        class WalletApiHandler : public WalletApiHandlerBase
+        {
+        public:
+
+            void onInvalidJsonRpc(const json& msg) override
+            {
+                WALLET_CHECK(!"invalid ev_subscribe api json!!!");
+
+                cout << msg["error"]["message"] << endl;
+            }
+
+            void onMessage(int id, const Subscribe& data) override
+            {
+                WALLET_CHECK(id > 0);
+
+                WALLET_CHECK(data.systemState);
+                WALLET_CHECK(data.txs);
+                WALLET_CHECK(!data.utxos);
+            }
+        };
+
+        WalletApiHandler handler;
+        WalletApi api(handler);
+
+        WALLET_CHECK(api.parse(msg.data(), msg.size()));
+
+        {
+            json res;
+            SystemStateChanged data;
+            data.stateID.m_Height = 123;
+            data.stateID.m_Hash = Zero;
+            api.getNotification(data, res);
+
+            WALLET_CHECK(res.find("id") == res.end());
+            WALLET_CHECK(res["method"] == "ev_system_state");
+            WALLET_CHECK(res["params"]["current_height"] == 123);
+        }
+
+        {
+            json res;
+            UtxosChanged data;
+            Coin coin(5);
+            coin.m_status = Coin::Available;
+            data.utxos.push_back(coin);
+            coin.m_ID.m_Idx = 1;
+            data.removed.push_back(coin.m_ID);
+            api.getNotification(data, res);
+
+            WALLET_CHECK(res.find("id") == res.end());
+            WALLET_CHECK(res["method"] == "ev_utxos_changed");
+            WALLET_CHECK(res["params"]["reset"] == false);
+            WALLET_CHECK(res["params"]["utxos"].size() == 1);
+            WALLET_CHECK(res["params"]["utxos"][0]["amount"] == 5);
+            WALLET_CHECK(res["params"]["removed"].size() == 1);
+            WALLET_CHECK(res["params"]["removed"][0] == coin.toStringID());
+        }
+    }
+
+    void testBatchJsonRpc(const std::string& msg)
+    {
+        class WalletApiHandler : public WalletApiHandlerBase
+        {
+        public:
+            int batches = 0;
+            bool inBatch = false;
+            std::vector<int> ids;
+            std::vector<json> errors;
+
+            void onBatchBegin() override
+            {
+                WALLET_CHECK(!inBatch);
+                inBatch = true;
+                batches++;
+            }
+
+            void onBatchEnd() override
+            {
+                WALLET_CHECK(inBatch);
+                inBatch = false;
+            }
+
+            void onInvalidJsonRpc(const json& msg) override
+            {
+                WALLET_CHECK(inBatch);
+                errors.push_back(msg);
+            }
+
+            void onMessage(int id, const Status& data) override
+            {
+                WALLET_CHECK(inBatch);
+                ids.push_back(id);
+            }
+
+            void onMessage(int id, const WalletStatus& data) override
+            {
+                WALLET_CHECK(inBatch);
+                ids.push_back(id);
+            }
+        };
+
+        WalletApiHandler handler;
+        WalletApi api(handler);
+
+        WALLET_CHECK(api.parse(msg.data(), msg.size()));
+        WALLET_CHECK(handler.batches == 1);
+        WALLET_CHECK(!handler.inBatch);
+        WALLET_CHECK(handler.ids == std::vector<int>({ 1, 3 }));
+        WALLET_CHECK(handler.errors.size() == 1);
+
+        testErrorHeader(handler.errors[0]);
+        WALLET_CHECK(handler.errors[0]["id"] == 2);
+        WALLET_CHECK(handler.errors[0]["error"]["code"] == NOTFOUND_JSON_RPC);
+    }
 }
 
 int main()
@@ -658,5 +774,65 @@ int main()
         }
     }), true);
 
+    testSubscribeJsonRpc(JSON_CODE(
+    {
+        "jsonrpc": "2.0",
+        "id" : 12345,
+        "method" : "ev_subscribe",
+        "params" :
+        {
+            "system_state" : true,
+            "txs" : true
+        }
+    }));
+
+    testInvalidJsonRpc([](const json& msg)
+    {
+        testErrorHeader(msg);
+
+        WALLET_CHECK(msg["id"] == 12345);
+        WALLET_CHECK(msg["error"]["code"] == INVALID_PARAMS_JSON_RPC);
+    }, JSON_CODE(
+    {
+        "jsonrpc": "2.0",
+        "id" : 12345,
+        "method" : "ev_subscribe",
+        "params" :
+        {
+            "txs" : 1
+        }
+    }));
+
+    testBatchJsonRpc(JSON_CODE(
+    [
+        {
+            "jsonrpc": "2.0",
+            "id" : 1,
+            "method" : "tx_status",
+            "params" :
+            {
+                "txId" : "10c4b760c842433cb58339a0fafef3db"
+            }
+        },
+        {
+            "jsonrpc": "2.0",
+            "id" : 2,
+            "method" : "balance123"
+        },
+        {
+            "jsonrpc": "2.0",
+            "id" : 3,
+            "method" : "wallet_status"
+        }
+    ]));
+
+    testInvalidJsonRpc([](const json& msg)
+    {
+        testErrorHeader(msg);
+
+        WALLET_CHECK(msg["id"] == nullptr);
+        WALLET_CHECK(msg["error"]["code"] == INVALID_JSON_RPC);
+    }, JSON_CODE([]));
+
     return WALLET_CHECK_RESULT;
 }
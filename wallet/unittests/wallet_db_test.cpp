@@ -538,6 +538,208 @@ void TestTxRollback()
     WALLET_CHECK(coins[1].m_spentTxId.is_initialized() == false);
 }
 
+void TestTotals()
+{
+    cout << "\nWallet database totals test\n";
+
+    auto db = createSqliteWalletDB(); // height 134
+
+    // compares the maintained totals to the full scan
+    auto checkTotals = [&db]()
+    {
+        storage::Totals t(*db), t2;
+        t2.Init(*db);
+
+        WALLET_CHECK(t.Avail == t2.Avail);
+        WALLET_CHECK(t.Maturing == t2.Maturing);
+        WALLET_CHECK(t.Incoming == t2.Incoming);
+        WALLET_CHECK(t.Unavail == t2.Unavail);
+        WALLET_CHECK(t.Outgoing == t2.Outgoing);
+        WALLET_CHECK(t.AvailCoinbase == t2.AvailCoinbase);
+        WALLET_CHECK(t.Coinbase == t2.Coinbase);
+        WALLET_CHECK(t.AvailFee == t2.AvailFee);
+        WALLET_CHECK(t.Fee == t2.Fee);
+        WALLET_CHECK(t.Unspent == t2.Unspent);
+        return t;
+    };
+
+    checkTotals(); // empty, the totals are built here
+
+    Coin cAvail = CreateAvailCoin(5);
+    db->storeCoin(cAvail);
+
+    Coin cMaturing = CreateCoin(7, 140, 100);
+    cMaturing.m_ID.m_Type = Key::Type::Coinbase;
+    db->storeCoin(cMaturing);
+
+    Coin cUnavail = CreateCoin(11);
+    db->storeCoin(cUnavail);
+
+    storage::Totals t = checkTotals();
+    WALLET_CHECK(t.Avail == 5);
+    WALLET_CHECK(t.Maturing == 7);
+    WALLET_CHECK(t.Unavail == 11);
+    WALLET_CHECK(t.Coinbase == 7);
+
+    // coins of an ongoing tx
+    TxID txID = { { 4, 5, 6 } };
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+
+    Coin cIncoming = CreateCoin(13);
+    cIncoming.m_createTxId = txID;
+    db->storeCoin(cIncoming);
+
+    cAvail.m_spentTxId = txID;
+    db->saveCoin(cAvail);
+
+    t = checkTotals();
+    WALLET_CHECK(t.Avail == 0);
+    WALLET_CHECK(t.Outgoing == 5);
+    WALLET_CHECK(t.Incoming == 13);
+
+    // the tx status change affects its coins
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::Failed, false);
+    t = checkTotals();
+    WALLET_CHECK(t.Avail == 5);
+    WALLET_CHECK(t.Outgoing == 0);
+    WALLET_CHECK(t.Incoming == 0);
+    WALLET_CHECK(t.Unavail == 24);
+
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::Registering, false);
+    checkTotals();
+
+    db->deleteTx(txID);
+    checkTotals();
+
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::Registering, false);
+    checkTotals();
+
+    // tip change matures the coinbase, and the rollback returns it back
+    beam::Block::SystemState::ID id = { };
+    id.m_Height = 150;
+    db->setSystemStateID(id);
+    t = checkTotals();
+    WALLET_CHECK(t.Maturing == 0);
+    WALLET_CHECK(t.AvailCoinbase == 7);
+
+    id.m_Height = 120;
+    db->setSystemStateID(id);
+    t = checkTotals();
+    WALLET_CHECK(t.Maturing == 7);
+    WALLET_CHECK(t.AvailCoinbase == 0);
+
+    db->rollbackTx(txID);
+    checkTotals();
+
+    cMaturing.m_spentHeight = 130;
+    db->saveCoin(cMaturing);
+    checkTotals();
+
+    db->removeCoin(cUnavail.m_ID);
+    checkTotals();
+
+    db->rollbackConfirmedUtxo(110);
+    checkTotals();
+
+    db->clearCoins();
+    t = checkTotals();
+    WALLET_CHECK(t.Unavail == 0);
+}
+
+void TestCoinNotifications()
+{
+    cout << "\nWallet database coin notifications test\n";
+
+    struct Observer : IWalletDbObserver
+    {
+        std::vector<std::pair<ChangeAction, std::vector<Coin>>> m_Changes;
+
+        void onCoinsChanged(ChangeAction action, const std::vector<Coin>& items) override
+        {
+            m_Changes.emplace_back(action, items);
+        }
+
+        // expects exactly one change since the last call
+        const std::vector<Coin>& Pop(ChangeAction action)
+        {
+            WALLET_CHECK(m_Changes.size() == 1);
+            WALLET_CHECK(m_Changes.back().first == action);
+            m_Items = std::move(m_Changes.back().second);
+            m_Changes.clear();
+            return m_Items;
+        }
+
+        std::vector<Coin> m_Items;
+    } obs;
+
+    auto db = createSqliteWalletDB(); // height 134
+    db->subscribe(&obs);
+
+    Coin cMaturing = CreateCoin(7, 140, 100);
+    db->storeCoin(cMaturing);
+    {
+        const auto& v = obs.Pop(ChangeAction::Added);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == cMaturing.m_ID && v[0].m_status == Coin::Maturing);
+    }
+
+    std::vector<Coin> coins = { CreateCoin(3), CreateCoin(4) };
+    TxID txID = { { 7, 8, 9 } };
+    coins[0].m_createTxId = txID;
+    db->storeCoins(coins);
+    WALLET_CHECK(obs.Pop(ChangeAction::Added).size() == 2);
+
+    // the status of the tx coins changes together with the tx status
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+    {
+        const auto& v = obs.Pop(ChangeAction::Updated);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == coins[0].m_ID && v[0].m_status == Coin::Incoming);
+    }
+
+    // same status, no notification
+    storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false);
+    WALLET_CHECK(obs.m_Changes.empty());
+
+    coins[1].m_confirmHeight = 130;
+    coins[1].m_maturity = 130;
+    db->saveCoin(coins[1]);
+    {
+        const auto& v = obs.Pop(ChangeAction::Updated);
+        WALLET_CHECK(v.size() == 1 && v[0].m_status == Coin::Available);
+    }
+
+    // only the coins maturing in between
+    beam::Block::SystemState::ID id = { };
+    id.m_Height = 145;
+    db->setSystemStateID(id);
+    {
+        const auto& v = obs.Pop(ChangeAction::Updated);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == cMaturing.m_ID && v[0].m_status == Coin::Available);
+    }
+
+    db->rollbackConfirmedUtxo(120);
+    {
+        const auto& v = obs.Pop(ChangeAction::Updated);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == coins[1].m_ID && v[0].m_status == Coin::Unavailable);
+    }
+
+    db->rollbackTx(txID); // the unconfirmed output of the tx is gone
+    {
+        const auto& v = obs.Pop(ChangeAction::Removed);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == coins[0].m_ID);
+    }
+
+    db->removeCoin(cMaturing.m_ID);
+    {
+        const auto& v = obs.Pop(ChangeAction::Removed);
+        WALLET_CHECK(v.size() == 1 && v[0].m_ID == cMaturing.m_ID);
+    }
+
+    db->clearCoins();
+    WALLET_CHECK(obs.Pop(ChangeAction::Reset).empty());
+
+    db->unsubscribe(&obs);
+}
+
 void TestAddresses()
 {
     cout << "\nWallet database addresses test\n";
@@ -1232,6 +1434,8 @@ int main()
     TestSelect4();
     TestSelect5();
     TestSelect6();
+    TestTotals();
+    TestCoinNotifications();
     TestAddresses();
     TestExportImportTx();
     TestTxParameters();
@@ -97,6 +97,7 @@ public:
     void removeCoins(const std::vector<Coin::ID>&) override {}
     void removeCoin(const Coin::ID&) override {}
     void visitCoins(std::function<bool(const Coin& coin)>) override {}
+    void getTotals(storage::Totals& totals) override { totals.Init(*this); }
     void setVarRaw(const char*, const void*, size_t) override {}
     bool getVarRaw(const char*, void*, int) const override { return false; }
     bool getBlob(const char* name, ByteBuffer& var) const override { return false; }
@@ -133,6 +133,7 @@ namespace beam::wallet
         REQUEST_TYPES_All(THE_MACRO)
 #undef THE_MACRO
 
+        UnsubscribeUtxoEvents();
         m_MessageEndpoints.clear();
         m_NodeEndpoint = nullptr;
     }
@@ -162,7 +163,10 @@ namespace beam::wallet
         {
             assert(m_OwnedNodesOnline); // check that m_OwnedNodesOnline is positive number
             if (!--m_OwnedNodesOnline)  
+            {
                 AbortUtxoEvents();
+                UnsubscribeUtxoEvents(); // would be renewed after the catch-up
+            }
         }
     }
 
@@ -328,6 +332,7 @@ namespace beam::wallet
         m_WalletDB->saveCoins(ocoins);
 
         storage::setVar(*m_WalletDB, s_szNextUtxoEvt, 0);
+        UnsubscribeUtxoEvents();
         RequestUtxoEvents();
         RefreshTransactions();
     }
@@ -799,9 +804,8 @@ namespace beam::wallet
         m_WalletDB->get_History().get_Tip(sTip);
 
         Height h = GetUtxoEventsHeightNext();
-        assert(h <= sTip.m_Height + 1);
         if (h > sTip.m_Height)
-            return;
+            return; // may also be ahead of the tip, if the events were pushed before it
 
         if (!m_PendingUtxoEvents.empty())
         {
@@ -823,8 +827,53 @@ namespace beam::wallet
 
     void Wallet::OnRequestComplete(MyRequestUtxoEvents& r)
     {
-        std::vector<proto::UtxoEvent>& v = r.m_Res.m_Events;
+        ProcessUtxoEvents(r.m_Res.m_Events);
+
+		if (r.m_Res.m_Events.size() < proto::UtxoEvent::s_Max)
+		{
+			Block::SystemState::Full sTip;
+			m_WalletDB->get_History().get_Tip(sTip);
+
+			SetUtxoEventsHeight(sTip.m_Height);
 
+            // caught up, the owned node would push the rest
+            if (m_NodeEndpoint)
+                m_NodeEndpoint->UtxoEventsSubscribe(sTip.m_Height + 1, this);
+		}
+        else
+        {
+            SetUtxoEventsHeight(r.m_Res.m_Events.back().m_Height);
+            RequestUtxoEvents(); // maybe more events pending
+        }
+    }
+
+    void Wallet::OnMsg(proto::UtxoEventsNew&& msg)
+    {
+        Height h = GetUtxoEventsHeightNext();
+        if ((msg.m_HeightMin > h) || (msg.m_HeightNext <= h))
+            return; // gap or duplicate, would be handled by polling
+
+        if (msg.m_HeightMin < h)
+        {
+            // overlaps what's already processed
+            auto it = std::find_if(msg.m_Events.begin(), msg.m_Events.end(), [h](const proto::UtxoEvent& evt) { return evt.m_Height >= h; });
+            msg.m_Events.erase(msg.m_Events.begin(), it);
+        }
+
+        ProcessUtxoEvents(msg.m_Events);
+        SetUtxoEventsHeight(msg.m_HeightNext - 1);
+
+        AbortUtxoEvents(); // pending request (if any) is outdated
+    }
+
+    void Wallet::UnsubscribeUtxoEvents()
+    {
+        if (m_NodeEndpoint)
+            m_NodeEndpoint->UtxoEventsSubscribe(0, nullptr);
+    }
+
+    void Wallet::ProcessUtxoEvents(std::vector<proto::UtxoEvent>& v)
+    {
         function<Point(const Key::IDV&)> commitmentFunc;
         if (m_KeyKeeper)
         {
@@ -866,19 +915,6 @@ namespace beam::wallet
 					}
 				}
             }
-        }
-
-		if (r.m_Res.m_Events.size() < proto::UtxoEvent::s_Max)
-		{
-			Block::SystemState::Full sTip;
-			m_WalletDB->get_History().get_Tip(sTip);
-
-			SetUtxoEventsHeight(sTip.m_Height);
-		}
-        else
-        {
-            SetUtxoEventsHeight(r.m_Res.m_Events.back().m_Height);
-            RequestUtxoEvents(); // maybe more events pending
         }
     }
 
@@ -86,6 +86,7 @@ namespace beam::wallet
     class Wallet
         : public IWallet
         , public INegotiatorGateway
+        , public proto::FlyClient::IUtxoEventsReceiver
     {
     public:
 
@@ -155,6 +156,9 @@ namespace beam::wallet
         Block::SystemState::IHistory& get_History() override;
         void OnOwnedNode(const PeerID&, bool bUp) override;
 
+        // IUtxoEventsReceiver
+        void OnMsg(proto::UtxoEventsNew&&) override;
+
         struct RequestHandler
             : public proto::FlyClient::Request::IHandler
         {
@@ -173,7 +177,9 @@ namespace beam::wallet
         void saveKnownState();
         void RequestUtxoEvents();
         void AbortUtxoEvents();
+        void ProcessUtxoEvents(std::vector<proto::UtxoEvent>&);
         void ProcessUtxoEvent(const proto::UtxoEvent&);
+        void UnsubscribeUtxoEvents();
         void SetUtxoEventsHeight(Height);
         Height GetUtxoEventsHeightNext();
 
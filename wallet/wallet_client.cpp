@@ -174,6 +174,7 @@ namespace beam::wallet
         , m_async{ make_shared<WalletModelBridge>(*(static_cast<IWalletModelAsync*>(this)), *m_reactor) }
         , m_isConnected(false)
         , m_nodeAddrStr(nodeAddr)
+        , m_utxoSeq(0)
     {
     }
 
@@ -369,13 +370,17 @@ namespace beam::wallet
         return m_walletDB->getCurrentHeight() >= Rules::get().pForks[1].m_Height;
     }
 
-    void WalletClient::onCoinsChanged()
+    void WalletClient::onCoinsChanged(ChangeAction action, const std::vector<Coin>& items)
     {
-        onAllUtxoChanged(getUtxos());
-        // TODO may be it needs to delete
+        onUtxoChanged(action, items, ++m_utxoSeq);
         onStatus(getStatus());
     }
 
+    void WalletClient::onUtxoChanged(ChangeAction, const std::vector<Coin>&, uint64_t seq)
+    {
+        onAllUtxoChanged(getUtxos(), seq);
+    }
+
     void WalletClient::onTransactionChanged(ChangeAction action, std::vector<TxDescription>&& items)
     {
         onTxStatus(action, move(items));
@@ -507,7 +512,7 @@ namespace beam::wallet
     void WalletClient::getUtxosStatus()
     {
         onStatus(getStatus());
-        onAllUtxoChanged(getUtxos());
+        onAllUtxoChanged(getUtxos(), m_utxoSeq);
     }
 
     void WalletClient::getAddresses(bool own)
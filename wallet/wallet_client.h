@@ -68,7 +68,11 @@ namespace beam::wallet
         virtual void onTxStatus(ChangeAction, const std::vector<TxDescription>& items) = 0;
         virtual void onSyncProgressUpdated(int done, int total) = 0;
         virtual void onChangeCalculated(Amount change) = 0;
-        virtual void onAllUtxoChanged(const std::vector<Coin>& utxos) = 0;
+        // Coin deltas, seq is incremented on each of them. Consumers apply them on top of the last snapshot,
+        // on a gap in seq they request a new one (getUtxosStatus). The default implementation sends the snapshot right away.
+        virtual void onUtxoChanged(ChangeAction, const std::vector<Coin>& utxos, uint64_t seq);
+        // Snapshot of all the coins, includes the changes up to seq
+        virtual void onAllUtxoChanged(const std::vector<Coin>& utxos, uint64_t seq) = 0;
         virtual void onAddresses(bool own, const std::vector<WalletAddress>& addresses) = 0;
         virtual void onGeneratedNewAddress(const WalletAddress& walletAddr) = 0;
         virtual void onNewAddressFailed() = 0;
@@ -85,7 +89,7 @@ namespace beam::wallet
 
     private:
 
-        void onCoinsChanged() override;
+        void onCoinsChanged(ChangeAction action, const std::vector<Coin>& items) override;
         void onTransactionChanged(ChangeAction action, std::vector<TxDescription>&& items) override;
         void onSystemStateChanged() override;
         void onAddressChanged(ChangeAction action, const std::vector<WalletAddress>& items) override;
@@ -134,5 +138,6 @@ namespace beam::wallet
         bool m_isConnected;
         boost::optional<ErrorType> m_walletError;
         std::string m_nodeAddrStr;
+        uint64_t m_utxoSeq;
     };
 }
@@ -18,7 +18,14 @@
 #include "utility/helpers.h"
 #include "sqlite/sqlite3.h"
 #include "core/block_rw.h"
+#include "utility/io/buffer.h"
 #include <sstream>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <boost/functional/hash.hpp>
 #include <boost/filesystem.hpp>
 #include "nlohmann/json.hpp"
@@ -698,7 +705,9 @@ namespace beam::wallet
         const char* SystemStateIDName = "SystemStateID";
         const char* LastUpdateTimeName = "LastUpdateTime";
         const int BusyTimeoutMs = 5000;
-        const int DbVersion = 15;
+        const int DbVersion = 17;
+        const int DbVersion16 = 16;
+        const int DbVersion15 = 15;
         const int DbVersion14 = 14;
         const int DbVersion13 = 13;
         const int DbVersion12 = 12;
@@ -818,7 +827,10 @@ namespace beam::wallet
         {
             const char* req = "CREATE TABLE " STORAGE_NAME " (" ENUM_ALL_STORAGE_FIELDS(LIST_WITH_TYPES, COMMA, ) ");"
                 "CREATE UNIQUE INDEX CoinIndex ON " STORAGE_NAME "(" ENUM_STORAGE_ID(LIST, COMMA, )  ");"
-                "CREATE INDEX ConfirmIndex ON " STORAGE_NAME"(confirmHeight);";
+                "CREATE INDEX ConfirmIndex ON " STORAGE_NAME"(confirmHeight);"
+                "CREATE INDEX MaturityIndex ON " STORAGE_NAME"(maturity);"
+                "CREATE INDEX CreateTxIndex ON " STORAGE_NAME"(createTxId);"
+                "CREATE INDEX SpentTxIndex ON " STORAGE_NAME"(spentTxId);";
             int ret = sqlite3_exec(db, req, nullptr, nullptr, nullptr);
             throwIfError(ret, db);
         }
@@ -1167,6 +1179,30 @@ namespace beam::wallet
                             }
 
                         }
+                        // no break;
+
+                    case DbVersion15:
+                        {
+                            LOG_INFO() << "Converting DB from format 15";
+
+                            // storage table changed: added index on [maturity], used to update the balance totals on tip change
+                            const char* req = "CREATE INDEX IF NOT EXISTS MaturityIndex ON " STORAGE_NAME "(maturity);";
+                            int ret = sqlite3_exec(walletDB->_db, req, NULL, NULL, NULL);
+                            throwIfError(ret, walletDB->_db);
+                        }
+                        // no break;
+
+                    case DbVersion16:
+                        {
+                            LOG_INFO() << "Converting DB from format 16";
+
+                            // storage table changed: added indexes on [createTxId] and [spentTxId], used to notify about the coins of the tx on its status change
+                            const char* req =
+                                "CREATE INDEX IF NOT EXISTS CreateTxIndex ON " STORAGE_NAME "(createTxId);"
+                                "CREATE INDEX IF NOT EXISTS SpentTxIndex ON " STORAGE_NAME "(spentTxId);";
+                            int ret = sqlite3_exec(walletDB->_db, req, NULL, NULL, NULL);
+                            throwIfError(ret, walletDB->_db);
+                        }
 
                         storage::setVar(*walletDB, Version, DbVersion);
                         // no break;
@@ -1268,6 +1304,7 @@ namespace beam::wallet
         , m_PrivateDB(sdb)
         , m_Reactor(reactor)
         , m_IsFlushPending(false)
+        , m_TotalsHeight(0)
     {
 
     }
@@ -1325,6 +1362,130 @@ namespace beam::wallet
         SwitchCommitment().Create(sk, comm, *get_ChildKdf(cid), cid);
     }
 
+	namespace
+	{
+		// Fixed set of threads, created once per import, that run the same job on request
+		class RecoveryWorkers
+		{
+			std::vector<std::thread> m_vThreads;
+			std::mutex m_Mutex;
+			std::condition_variable m_cvJob;
+			std::condition_variable m_cvDone;
+			const std::function<void()>* m_pJob = nullptr;
+			uint64_t m_Generation = 0;
+			size_t m_Pending = 0;
+			bool m_Stop = false;
+
+			void Thread()
+			{
+				for (uint64_t nGeneration = 0; ; )
+				{
+					const std::function<void()>* pJob;
+					{
+						std::unique_lock<std::mutex> lock(m_Mutex);
+						m_cvJob.wait(lock, [this, nGeneration] { return m_Stop || (m_Generation != nGeneration); });
+						if (m_Stop)
+							break;
+
+						nGeneration = m_Generation;
+						pJob = m_pJob;
+					}
+
+					(*pJob)();
+
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					if (!--m_Pending)
+						m_cvDone.notify_one();
+				}
+			}
+
+		public:
+			RecoveryWorkers()
+			{
+				uint32_t nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+				for (uint32_t i = 1; i < nThreads; i++)
+					m_vThreads.emplace_back(&RecoveryWorkers::Thread, this);
+			}
+
+			~RecoveryWorkers()
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_Stop = true;
+				}
+				m_cvJob.notify_all();
+
+				for (auto& t : m_vThreads)
+					t.join();
+			}
+
+			uint32_t get_Threads() const
+			{
+				return static_cast<uint32_t>(m_vThreads.size() + 1);
+			}
+
+			// runs the job on all the threads, including the caller, and waits for all of them
+			void Run(const std::function<void()>& job)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_pJob = &job;
+					m_Pending = m_vThreads.size();
+					m_Generation++;
+				}
+				m_cvJob.notify_all();
+
+				job();
+
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_cvDone.wait(lock, [this] { return !m_Pending; });
+				m_pJob = nullptr;
+			}
+		};
+
+		struct RecoveredCoin
+		{
+			Key::IDV m_Kidv;
+			Height m_CreateHeight;
+			Height m_Maturity;
+			ECC::Point m_Commitment;
+
+			bool Recover(const RecoveryInfo::Entry& x, Key::IPKdf& owner)
+			{
+				if (!x.m_Output.Recover(x.m_CreateHeight, owner, m_Kidv))
+					return false;
+
+				m_CreateHeight = x.m_CreateHeight;
+				m_Maturity = x.m_Output.get_MinMaturity(x.m_CreateHeight);
+				m_Commitment = x.m_Output.m_Commitment;
+				return true;
+			}
+
+			void Save(IWalletDB& db) const
+			{
+				if (!m_Kidv.m_Value && (Key::Type::Decoy == m_Kidv.m_Type))
+					return; // filter-out decoys
+
+				ECC::Scalar::Native sk;
+				ECC::Point comm;
+				db.calcCommitment(sk, comm, m_Kidv);
+				if (!(comm == m_Commitment))
+					return;
+
+				Coin c;
+				c.m_ID = m_Kidv;
+				db.findCoin(c); // in case it exists already - fill its parameters
+
+				c.m_maturity = m_Maturity;
+				c.m_confirmHeight = m_CreateHeight;
+
+				LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << c.m_maturity << " Recovered";
+
+				db.saveCoin(c);
+			}
+		};
+	}
+
 	void IWalletDB::ImportRecovery(const std::string& path)
 	{
 		IRecoveryProgress prog;
@@ -1333,52 +1494,185 @@ namespace beam::wallet
 
 	bool IWalletDB::ImportRecovery(const std::string& path, IRecoveryProgress& prog)
 	{
-		beam::RecoveryInfo::Reader rp;
-		rp.Open(path.c_str());
-		uint64_t nTotal = rp.m_Stream.get_Remaining();
+		return ImportRecovery(path, 0, prog);
+	}
 
+	bool IWalletDB::ImportRecovery(const std::string& path, Height hMin, IRecoveryProgress& prog)
+	{
 		beam::Key::IPKdf::Ptr pOwner = get_MasterKdf();
+		RecoveryWorkers workers;
 
-		while (true)
-		{
-			RecoveryInfo::Entry x;
-			if (!rp.Read(x))
-				break;
-
-			uint64_t nRemaining = rp.m_Stream.get_Remaining();
-			if (!prog.OnProgress(nTotal - nRemaining, nTotal))
-				return false;
-
-			Key::IDV kidv;
-			if (!x.m_Output.Recover(x.m_CreateHeight, *pOwner, kidv))
-				continue;
-
-			if (!kidv.m_Value && (Key::Type::Decoy == kidv.m_Type))
-				continue; // filter-out decoys
+		Block::ChainWorkProof cwp;
 
-			ECC::Scalar::Native sk;
-			ECC::Point comm;
-			calcCommitment(sk, comm, kidv);
-			if (!(comm == x.m_Output.m_Commitment))
-				continue;
-
-			Coin c;
-			c.m_ID = kidv;
-			findCoin(c); // in case it exists already - fill its parameters
-
-			c.m_maturity = x.m_Output.get_MinMaturity(x.m_CreateHeight);
-			c.m_confirmHeight = x.m_CreateHeight;
-
-			LOG_INFO() << "CoinID: " << c.m_ID << " Maturity=" << c.m_maturity << " Recovered";
-
-			saveCoin(c);
+		if (RecoveryInfo::SegmentedReader::IsSegmented(path.c_str()))
+		{
+			RecoveryInfo::SegmentedReader rs;
+			rs.Open(path.c_str());
+
+			io::SharedBuffer buf = io::map_file_read_only(path.c_str());
+			Blob file(buf.data, static_cast<uint32_t>(buf.size));
+
+			// Segments are independent, each thread picks the next one, parses and verifies it, and makes the recovery attempts.
+			// The UTXO set is verified only if all the segments are scanned.
+			struct Segment
+			{
+				const RecoveryInfo::Segment* m_pSeg;
+				std::vector<RecoveredCoin> m_vRecovered;
+				std::vector<UtxoTree::Key> m_vKeys;
+			};
+
+			std::vector<Segment> vSegs;
+			uint64_t nTotal = 0;
+			for (const auto& seg : rs.m_Index.m_vSegments)
+			{
+				if (seg.m_Heights.m_Max < hMin)
+					continue;
+
+				vSegs.emplace_back().m_pSeg = &seg;
+				nTotal += seg.m_Size;
+			}
+
+			bool bVerify = (vSegs.size() == rs.m_Index.m_vSegments.size());
+
+			std::vector<UtxoTree::Key> vKeys;
+			uint64_t nDone = 0;
+
+			const size_t nRound = workers.get_Threads() * 4;
+			for (size_t i0 = 0; i0 < vSegs.size(); )
+			{
+				size_t i1 = std::min(i0 + nRound, vSegs.size());
+
+				std::atomic<size_t> iNext(i0);
+				std::exception_ptr pExc;
+				std::mutex mxExc;
+
+				workers.Run([&]()
+				{
+					try
+					{
+						while (true)
+						{
+							size_t i = iNext++;
+							if (i >= i1)
+								break;
+
+							Segment& s = vSegs[i];
+
+							RecoveryInfo::SegmentParser sp;
+							sp.Open(*s.m_pSeg, file);
+
+							while (true)
+							{
+								RecoveryInfo::Entry x;
+								if (!sp.Read(x))
+									break;
+
+								if (bVerify)
+									RecoveryInfo::get_Key(s.m_vKeys.emplace_back(), x);
+
+								RecoveredCoin rc;
+								if (rc.Recover(x, *pOwner))
+									s.m_vRecovered.push_back(rc);
+							}
+						}
+					}
+					catch (...)
+					{
+						std::unique_lock<std::mutex> lock(mxExc);
+						pExc = std::current_exception();
+					}
+				});
+
+				if (pExc)
+					std::rethrow_exception(pExc);
+
+				for (; i0 < i1; i0++)
+				{
+					Segment& s = vSegs[i0];
+					for (const auto& rc : s.m_vRecovered)
+						rc.Save(*this);
+
+					vKeys.insert(vKeys.end(), s.m_vKeys.begin(), s.m_vKeys.end());
+					std::vector<UtxoTree::Key>().swap(s.m_vKeys);
+
+					nDone += s.m_pSeg->m_Size;
+				}
+
+				if (!prog.OnProgress(nDone, nTotal))
+					return false;
+			}
+
+			if (bVerify)
+				RecoveryInfo::VerifyUtxos(vKeys, rs.m_Index.m_Cwp.m_hvRootLive); // final verification
+
+			cwp = std::move(rs.m_Index.m_Cwp);
+		}
+		else
+		{
+			beam::RecoveryInfo::Reader rp;
+			rp.Open(path.c_str());
+			uint64_t nTotal = rp.m_Stream.get_Remaining();
+
+			// Entries are read (and verified vs UTXO tree) sequentially, in batches.
+			// Recovery attempts (rangeproof rewinds) of each batch are split between the threads.
+			std::deque<RecoveryInfo::Entry> queEntries; // Entry is not movable
+			std::vector<RecoveredCoin> vRecovered;
+			std::vector<uint8_t> vRecoveredFlags;
+			std::atomic<size_t> iNext;
+
+			std::function<void()> job = [&]()
+			{
+				while (true)
+				{
+					size_t i = iNext++;
+					if (i >= queEntries.size())
+						break;
+
+					vRecoveredFlags[i] = vRecovered[i].Recover(queEntries[i], *pOwner);
+				}
+			};
+
+			const size_t nBatchSize = 0x400;
+
+			while (true)
+			{
+				queEntries.clear();
+				while (queEntries.size() < nBatchSize)
+				{
+					queEntries.emplace_back();
+					if (!rp.Read(queEntries.back()))
+					{
+						queEntries.pop_back();
+						break;
+					}
+				}
+
+				if (queEntries.empty())
+					break;
+
+				uint64_t nRemaining = rp.m_Stream.get_Remaining();
+				if (!prog.OnProgress(nTotal - nRemaining, nTotal))
+					return false;
+
+				vRecovered.resize(queEntries.size());
+				vRecoveredFlags.assign(queEntries.size(), 0);
+				iNext = 0;
+
+				workers.Run(job);
+
+				for (size_t i = 0; i < queEntries.size(); i++)
+					if (vRecoveredFlags[i])
+						vRecovered[i].Save(*this);
+			}
+
+			rp.Finalyze(); // final verification
+
+			cwp = std::move(rp.m_Cwp);
 		}
-
-		rp.Finalyze(); // final verification
 
 		// add states to history
 		std::vector<Block::SystemState::Full> vec;
-		rp.m_Cwp.UnpackStates(vec);
+		cwp.UnpackStates(vec);
 
 		if (!vec.empty())
 			get_History().AddStates(&vec.front(), vec.size());
@@ -1508,6 +1802,8 @@ namespace beam::wallet
         int colIdx = 0;
         ENUM_ALL_STORAGE_FIELDS(STM_BIND_LIST, NOSEP, coin);
         stm.step();
+
+        updateTotals(coin, true);
     }
 
     void WalletDB::insertNewCoin(Coin& coin)
@@ -1523,6 +1819,11 @@ namespace beam::wallet
 
     bool WalletDB::updateCoinRaw(const Coin& coin)
     {
+        Coin cPrev;
+        cPrev.m_ID = coin.m_ID;
+        if (m_pTotals && !findCoin(cPrev))
+            return false;
+
         const char* req = "UPDATE " STORAGE_NAME " SET " ENUM_STORAGE_FIELDS(SET_LIST, COMMA, ) STORAGE_WHERE_ID  ";";
         sqlite::Statement stm(this, req);
 
@@ -1531,7 +1832,12 @@ namespace beam::wallet
         ENUM_STORAGE_ID(STM_BIND_LIST, NOSEP, coin);
         stm.step();
 
-        return sqlite3_changes(_db) > 0;
+        if (sqlite3_changes(_db) <= 0)
+            return false;
+
+        updateTotals(cPrev, false);
+        updateTotals(coin, true);
+        return true;
     }
 
     void WalletDB::saveCoinRaw(const Coin& coin)
@@ -1552,7 +1858,7 @@ namespace beam::wallet
     {
         coin.m_ID.m_Idx = get_RandomID();
         insertNewCoin(coin);
-        notifyCoinsChanged();
+        notifyCoinsChanged(ChangeAction::Added, { coin });
     }
 
     void WalletDB::storeCoins(std::vector<Coin>& coins)
@@ -1567,13 +1873,13 @@ namespace beam::wallet
             insertNewCoin(coin);
             nKeyIndex = coin.m_ID.m_Idx + 1;
         }
-        notifyCoinsChanged();
+        notifyCoinsChanged(ChangeAction::Added, coins);
     }
 
     void WalletDB::saveCoin(const Coin& coin)
     {
         saveCoinRaw(coin);
-        notifyCoinsChanged();
+        notifyCoinsChanged(ChangeAction::Updated, { coin });
     }
 
     void WalletDB::saveCoins(const vector<Coin>& coins)
@@ -1586,7 +1892,7 @@ namespace beam::wallet
             saveCoinRaw(coin);
         }
 
-        notifyCoinsChanged();
+        notifyCoinsChanged(ChangeAction::Updated, coins);
     }
 
     uint64_t WalletDB::get_RandomID()
@@ -1627,15 +1933,27 @@ namespace beam::wallet
     {
         if (coins.size())
         {
-            for (const auto& cid : coins)
-                removeCoinImpl(cid);
+            vector<Coin> removed(coins.size());
+            for (size_t i = 0; i < coins.size(); i++)
+            {
+                removeCoinImpl(coins[i]);
+                removed[i].m_ID = coins[i];
+            }
 
-            notifyCoinsChanged();
+            notifyCoinsChanged(ChangeAction::Removed, removed);
         }
     }
 
     void WalletDB::removeCoinImpl(const Coin::ID& cid)
     {
+        if (m_pTotals)
+        {
+            Coin cPrev;
+            cPrev.m_ID = cid;
+            if (findCoin(cPrev))
+                updateTotals(cPrev, false);
+        }
+
         const char* req = "DELETE FROM " STORAGE_NAME STORAGE_WHERE_ID;
         sqlite::Statement stm(this, req);
 
@@ -1655,14 +1973,21 @@ namespace beam::wallet
     void WalletDB::removeCoin(const Coin::ID& cid)
     {
         removeCoinImpl(cid);
-        notifyCoinsChanged();
+
+        Coin coin;
+        coin.m_ID = cid;
+        notifyCoinsChanged(ChangeAction::Removed, { coin });
     }
 
     void WalletDB::clearCoins()
     {
         sqlite::Statement stm(this, "DELETE FROM " STORAGE_NAME ";");
         stm.step();
-        notifyCoinsChanged();
+
+        if (m_pTotals)
+            ZeroObject(*m_pTotals);
+
+        notifyCoinsChanged(ChangeAction::Reset, {});
     }
 
     bool WalletDB::findCoin(Coin& coin)
@@ -1705,6 +2030,102 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::getTotals(storage::Totals& totals)
+    {
+        if (!m_pTotals)
+        {
+            auto pTotals = std::make_unique<storage::Totals>();
+            pTotals->Init(*this);
+
+            m_TotalsHeight = getCurrentHeight();
+            m_pTotals = std::move(pTotals);
+        }
+
+        totals = *m_pTotals;
+    }
+
+    void WalletDB::updateTotals(const Coin& coin, bool bAdd)
+    {
+        if (!m_pTotals)
+            return;
+
+        Coin c = coin;
+        storage::DeduceStatus(*this, c, m_TotalsHeight);
+        m_pTotals->AddCoin(c, bAdd);
+    }
+
+    void WalletDB::onHeightChanged(Height hPrev, Height h)
+    {
+        if (m_pTotals && (m_TotalsHeight != hPrev))
+            m_pTotals.reset(); // the height was set bypassing setSystemStateID
+
+        if ((hPrev == h) || (!m_pTotals && m_subscribers.empty()))
+            return;
+
+        // only the unspent coins that mature in between may change their status (Maturing <-> Available/Outgoing)
+        sqlite::Statement stm(this, "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE maturity>?1 AND maturity<=?2 AND spentHeight<0;");
+        stm.bind(1, std::min(h, hPrev));
+        stm.bind(2, std::max(h, hPrev));
+
+        vector<Coin> coins;
+        while (stm.step())
+        {
+            auto& coin = coins.emplace_back();
+
+            int colIdx = 0;
+            ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+            if (m_pTotals)
+            {
+                storage::DeduceStatus(*this, coin, hPrev);
+                m_pTotals->AddCoin(coin, false);
+
+                storage::DeduceStatus(*this, coin, h);
+                m_pTotals->AddCoin(coin, true);
+            }
+        }
+
+        m_TotalsHeight = h;
+
+        if (!coins.empty())
+            notifyCoinsChanged(ChangeAction::Updated, coins);
+    }
+
+    std::vector<Coin> WalletDB::beginTxCoinsUpdate(const TxID& txID)
+    {
+        std::vector<Coin> coins;
+        if (m_pTotals || !m_subscribers.empty())
+        {
+            coins = getCoinsByTx(txID);
+            for (const auto& coin : coins)
+                updateTotals(coin, false);
+        }
+        return coins;
+    }
+
+    void WalletDB::endTxCoinsUpdate(const std::vector<Coin>& coins)
+    {
+        // re-read, the coins could be modified or deleted meanwhile
+        vector<Coin> updated, removed;
+        for (const auto& coin : coins)
+        {
+            Coin c; // fresh, NULL fields don't overwrite
+            c.m_ID = coin.m_ID;
+            if (findCoin(c))
+            {
+                updateTotals(c, true);
+                updated.push_back(std::move(c));
+            }
+            else
+                removed.push_back(std::move(c));
+        }
+
+        if (!removed.empty())
+            notifyCoinsChanged(ChangeAction::Removed, removed);
+        if (!updated.empty())
+            notifyCoinsChanged(ChangeAction::Updated, updated);
+    }
+
     void WalletDB::setVarRaw(const char* name, const void* data, size_t size)
     {
         const char* req = "INSERT or REPLACE INTO " VARIABLES_NAME " (" VARIABLES_FIELDS ") VALUES(?1, ?2);";
@@ -1773,8 +2194,10 @@ namespace beam::wallet
 
     void WalletDB::setSystemStateID(const Block::SystemState::ID& stateID)
     {
+        Height hPrev = getCurrentHeight();
         storage::setVar(*this, SystemStateIDName, stateID);
         storage::setVar(*this, LastUpdateTimeName, getTimestamp());
+        onHeightChanged(hPrev, stateID.m_Height);
         notifySystemStateChanged();
     }
 
@@ -1795,6 +2218,25 @@ namespace beam::wallet
 
     void WalletDB::rollbackConfirmedUtxo(Height minHeight)
     {
+        vector<Coin> coins;
+        if (!m_subscribers.empty())
+        {
+            sqlite::Statement stm(this, "SELECT " STORAGE_FIELDS " FROM " STORAGE_NAME " WHERE confirmHeight > ?1 OR spentHeight > ?1;");
+            stm.bind(1, minHeight);
+
+            while (stm.step())
+            {
+                auto& coin = coins.emplace_back();
+                int colIdx = 0;
+                ENUM_ALL_STORAGE_FIELDS(STM_GET_LIST, NOSEP, coin);
+
+                if (coin.m_confirmHeight > minHeight)
+                    coin.m_confirmHeight = MaxHeight;
+                if (coin.m_spentHeight > minHeight)
+                    coin.m_spentHeight = MaxHeight;
+            }
+        }
+
         // UTXOs
         {
             const char* req = "UPDATE " STORAGE_NAME " SET confirmHeight=?1 WHERE confirmHeight > ?2;";
@@ -1812,7 +2254,10 @@ namespace beam::wallet
             stm.step();
         }
 
-        notifyCoinsChanged();
+        m_pTotals.reset(); // rare, would be rebuilt on demand
+
+        if (!coins.empty())
+            notifyCoinsChanged(ChangeAction::Updated, coins);
     }
 
     vector<TxDescription> WalletDB::getTxHistory(wallet::TxType txType, uint64_t start, int count) const
@@ -1993,20 +2438,27 @@ namespace beam::wallet
         auto tx = getTx(txId);
         if (tx.is_initialized())
         {
-            const char* req = "DELETE FROM " TX_PARAMS_NAME " WHERE txID=?1 AND paramID!=?2;";
-            sqlite::Statement stm(this, req);
+            // the tx status is gone, its coins aren't Incoming/Outgoing anymore
+            auto coins = beginTxCoinsUpdate(txId);
+            {
+                const char* req = "DELETE FROM " TX_PARAMS_NAME " WHERE txID=?1 AND paramID!=?2;";
+                sqlite::Statement stm(this, req);
 
-            stm.bind(1, txId);
-            stm.bind(2, TxParameterID::TransactionType);
+                stm.bind(1, txId);
+                stm.bind(2, TxParameterID::TransactionType);
+
+                stm.step();
+                deleteParametersFromCache(txId);
+            }
+            endTxCoinsUpdate(coins);
 
-            stm.step();
-            deleteParametersFromCache(txId);
             notifyTransactionChanged(ChangeAction::Removed, { *tx });
         }
     }
 
     void WalletDB::rollbackTx(const TxID& txId)
     {
+        auto coins = beginTxCoinsUpdate(txId);
         {
             const char* req = "UPDATE " STORAGE_NAME " SET spentTxId=NULL WHERE spentTxId=?1;";
             sqlite::Statement stm(this, req);
@@ -2020,7 +2472,7 @@ namespace beam::wallet
             stm.bind(2, MaxHeight);
             stm.step();
         }
-        notifyCoinsChanged();
+        endTxCoinsUpdate(coins);
     }
 
     boost::optional<WalletAddress> WalletDB::getAddress(const WalletID& id) const
@@ -2151,6 +2603,22 @@ namespace beam::wallet
     }
 
     bool WalletDB::setTxParameter(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const ByteBuffer& blob, bool shouldNotifyAboutChanges)
+    {
+        if ((TxParameterID::Status != paramID) || (kDefaultSubTxID != subTxID) || (!m_pTotals && m_subscribers.empty()))
+            return setTxParameterImpl(txID, subTxID, paramID, blob, shouldNotifyAboutChanges);
+
+        ByteBuffer prev;
+        if (getTxParameter(txID, subTxID, paramID, prev) && (prev == blob))
+            return false;
+
+        // the tx coins may switch between Incoming/Outgoing and Unavailable/Available
+        auto coins = beginTxCoinsUpdate(txID);
+        bool bRet = setTxParameterImpl(txID, subTxID, paramID, blob, shouldNotifyAboutChanges);
+        endTxCoinsUpdate(coins);
+        return bRet;
+    }
+
+    bool WalletDB::setTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const ByteBuffer& blob, bool shouldNotifyAboutChanges)
     {
         if (auto txIter = m_TxParametersCache.find(txID); txIter != m_TxParametersCache.end())
         {
@@ -2329,9 +2797,24 @@ namespace beam::wallet
         }
     }
 
-    void WalletDB::notifyCoinsChanged()
+    void WalletDB::notifyCoinsChanged(ChangeAction action, const vector<Coin>& items)
     {
-        for (auto sub : m_subscribers) sub->onCoinsChanged();
+        if (m_subscribers.empty())
+            return;
+
+        if (ChangeAction::Removed == action)
+        {
+            for (auto sub : m_subscribers) sub->onCoinsChanged(action, items);
+            return;
+        }
+
+        // the statuses of the passed coins may be stale
+        vector<Coin> coins = items;
+        Height h = getCurrentHeight();
+        for (auto& coin : coins)
+            storage::DeduceStatus(*this, coin, h);
+
+        for (auto sub : m_subscribers) sub->onCoinsChanged(action, coins);
     }
 
     void WalletDB::notifyTransactionChanged(ChangeAction action, vector<TxDescription>&& items)
@@ -2675,46 +3158,51 @@ namespace beam::wallet
 
             walletDB.visitCoins([this](const Coin& c)->bool
             {
-                const Amount& v = c.m_ID.m_Value; // alias
-                switch (c.m_status)
-                {
-                case Coin::Status::Available:
-                    Avail += v;
-                    Unspent += v;
-
-                    switch (c.m_ID.m_Type)
-                    {
-                    case Key::Type::Coinbase: AvailCoinbase += v; break;
-                    case Key::Type::Comission: AvailFee += v; break;
-                    default: // suppress warning
-                        break;
-                    }
-
-                    break;
-
-                case Coin::Status::Maturing:
-                    Maturing += v;
-                    Unspent += v;
-                    break;
-
-                case Coin::Status::Incoming: Incoming += v; break;
-                case Coin::Status::Outgoing: Outgoing += v; break;
-                case Coin::Status::Unavailable: Unavail += v; break;
+                AddCoin(c);
+                return true;
+            });
+        }
 
-                default: // suppress warning
-                    break;
-                }
+        void Totals::AddCoin(const Coin& c, bool bAdd)
+        {
+            // removal is done in the unsigned wrap-around arithmetics, cancels the previous addition
+            const Amount v = bAdd ? c.m_ID.m_Value : (0 - c.m_ID.m_Value);
+            switch (c.m_status)
+            {
+            case Coin::Status::Available:
+                Avail += v;
+                Unspent += v;
 
                 switch (c.m_ID.m_Type)
                 {
-                case Key::Type::Coinbase: Coinbase += v; break;
-                case Key::Type::Comission: Fee += v; break;
+                case Key::Type::Coinbase: AvailCoinbase += v; break;
+                case Key::Type::Comission: AvailFee += v; break;
                 default: // suppress warning
                     break;
                 }
 
-                return true;
-            });
+                break;
+
+            case Coin::Status::Maturing:
+                Maturing += v;
+                Unspent += v;
+                break;
+
+            case Coin::Status::Incoming: Incoming += v; break;
+            case Coin::Status::Outgoing: Outgoing += v; break;
+            case Coin::Status::Unavailable: Unavail += v; break;
+
+            default: // suppress warning
+                break;
+            }
+
+            switch (c.m_ID.m_Type)
+            {
+            case Key::Type::Coinbase: Coinbase += v; break;
+            case Key::Type::Comission: Fee += v; break;
+            default: // suppress warning
+                break;
+            }
         }
 
         WalletAddress createAddress(IWalletDB& walletDB)
@@ -162,12 +162,19 @@ namespace beam::wallet
 
     struct IWalletDbObserver
     {
-        virtual void onCoinsChanged() {};
+        // Removed items carry only the coin IDs, Reset carries the whole new set.
+        // Updated may also carry the coins that were saved for the first time
+        virtual void onCoinsChanged(ChangeAction action, const std::vector<Coin>& items) {};
         virtual void onTransactionChanged(ChangeAction action, std::vector<TxDescription>&& items) {};
         virtual void onSystemStateChanged() {};
         virtual void onAddressChanged(ChangeAction action, const std::vector<WalletAddress>& items) {};
     };
 
+    namespace storage
+    {
+        struct Totals;
+    }
+
     struct IWalletDB
     {
         using Ptr = std::shared_ptr<IWalletDB>;
@@ -197,6 +204,10 @@ namespace beam::wallet
 		// returns false if callback asked to stop verification.
 		bool ImportRecovery(const std::string& path, IRecoveryProgress&);
 
+		// For the segmented files scans only the segments above hMin, the UTXO set is verified only if all of them are scanned.
+		// The legacy files are always imported whole.
+		bool ImportRecovery(const std::string& path, Height hMin, IRecoveryProgress&);
+
         // Allocates new Key ID, used for generation of the blinding factor
         // Will return the next id starting from a random base created during wallet initialization
         virtual uint64_t AllocateKidRange(uint64_t nCount) = 0;
@@ -229,6 +240,9 @@ namespace beam::wallet
         // Generic visitor to iterate over coin collection
         virtual void visitCoins(std::function<bool(const Coin& coin)> func) = 0;
 
+        // Balance totals at the current height
+        virtual void getTotals(storage::Totals&) = 0;
+
         // Used in split API for session management
         virtual bool lockCoins(const CoinIDList& list, uint64_t session) = 0;
         virtual bool unlockCoins(uint64_t session) = 0;
@@ -331,6 +345,7 @@ namespace beam::wallet
         void clearCoins() override;
 
         void visitCoins(std::function<bool(const Coin& coin)> func) override;
+        void getTotals(storage::Totals&) override;
 
         void setVarRaw(const char* name, const void* data, size_t size) override;
         bool getVarRaw(const char* name, void* data, int size) const override;
@@ -384,7 +399,7 @@ namespace beam::wallet
 
     private:
         void removeCoinImpl(const Coin::ID& cid);
-        void notifyCoinsChanged();
+        void notifyCoinsChanged(ChangeAction action, const std::vector<Coin>& items);
         void notifyTransactionChanged(ChangeAction action, std::vector<TxDescription>&& items);
         void notifySystemStateChanged();
         void notifyAddressChanged(ChangeAction action, const std::vector<WalletAddress>& items);
@@ -395,6 +410,13 @@ namespace beam::wallet
         void insertNewCoin(Coin&);
         void saveCoinRaw(const Coin&);
 
+        bool setTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, const ByteBuffer& blob, bool shouldNotifyAboutChanges);
+
+        void updateTotals(const Coin&, bool bAdd);
+        void onHeightChanged(Height hPrev, Height h);
+        std::vector<Coin> beginTxCoinsUpdate(const TxID&); // coins which status depends on the tx
+        void endTxCoinsUpdate(const std::vector<Coin>&);
+
         // ////////////////////////////////////////
         // Cache for optimized access for database fields
         using ParameterCache = std::map<TxID, std::map<SubTxID, std::map<TxParameterID, boost::optional<ByteBuffer>>>>;
@@ -419,6 +441,10 @@ namespace beam::wallet
         std::unique_ptr<sqlite::Transaction> m_DbTransaction;
         std::vector<IWalletDbObserver*> m_subscribers;
 
+        // Built on the first request, then kept up to date on coin, tx status and tip changes
+        std::unique_ptr<storage::Totals> m_pTotals;
+        Height m_TotalsHeight; // the coin statuses are deduced at this height
+
         // Wallet has ablity to track blockchain state
         // This interface allows to check and update the blockchain state 
         // in the wallet database. Used in FlyClient implementation
@@ -528,8 +554,9 @@ namespace beam::wallet
             Amount Unspent = 0;
 
             Totals() {}
-            Totals(IWalletDB& db) { Init(db); }
-            void Init(IWalletDB&);
+            Totals(IWalletDB& db) { db.getTotals(*this); }
+            void Init(IWalletDB&); // visits all the coins
+            void AddCoin(const Coin&, bool bAdd = true); // according to its status
         };
 
         // Used for Payment Proof feature